@@ -2,6 +2,9 @@
 #include <base_schilling/SchillingRaw.hpp>
 #include <base_schilling/Error.hpp>
 #include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 #define CAL_VEL_COEFF 0.5
@@ -11,9 +14,13 @@ using namespace act_schilling::raw;
 using namespace std;
 using namespace oro_marum;
 
+const size_t ActHandler::POS_MSGS;
+
 ActHandler::ActHandler(const Config& config)
   : base_schilling::Driver(64),
-    mLastCmd(CMD_NONE), mConfig(config)
+    mLastCmd(CMD_NONE), mConfig(config),
+    mActData(base::Time()), mActDevStatus(base::Time()),
+    mActPosition(base::Time()), mActDriveStatus(base::Time()), mActInfo(base::Time())
 {
   mActData.ctrl_mode = config.ctrl_mode;
   mActRunState = RESET;
@@ -21,6 +28,22 @@ ActHandler::ActHandler(const Config& config)
   mUpdateState.pos_update = false;
   mUpdateState.drive_state_update = false;
   mUpdateState.act_info_update = false;
+  mUpdateSeq.status = 0;
+  mUpdateSeq.pos = 0;
+  mUpdateSeq.drive_status = 0;
+  mUpdateSeq.act_info = 0;
+  mJogState.active = false;
+  mJogState.vel = 0;
+  mMinCount = 0;
+  mMaxCount = 0;
+  mMoveLastPos.pos = 0;
+  mMoveLastPos.count = 0;
+  mMoveListener = 0;
+  mPublisher = 0;
+  //a count finer than a micro degree would break the round trip of the conversions
+  if(mConfig.counts_per_rev <= 0 || mConfig.counts_per_rev > ACT_UDEG_PER_REV){
+    mConfig.counts_per_rev = ACT_FULLPOS;
+  }
 }
 
 void ActHandler::initDevice()
@@ -31,15 +54,22 @@ void ActHandler::initDevice()
   mMsgQueue.clear();
   enqueueCmdMsg(CMD_CLRERR);
   enqueueCmdMsg(CMD_CLRERR);
-  enqueueCmdMsg(CMD_SETTRAPVEL, 0, 3);
+  //disarm a watchdog left armed by jog mode before a reset
+  enqueueCmdMsg(CMD_SETWD,0,2);
+  mConfig.trap_accel = clampTrapAccel(mConfig.trap_accel);
+  enqueueCmdMsg(CMD_SETTRAPVEL, mConfig.trap_accel, 3);
   enqueueCmdMsg(CMD_SETCTRLMODE,ctrlMode,1);
   enqueueCmdMsg(CMD_GETSTAT);  
 }
 
-void ActHandler::requestStatus()
+QueueState ActHandler::requestStatus()
 {
+  if(!hasQueueCapacity(2)){
+    return QUEUE_REJECTED;
+  }
   enqueueCmdMsg(CMD_GETSTAT);
   enqueueCmdMsg(CMD_GETPOS);
+  return getQueueState();
 }
 
 
@@ -65,46 +95,178 @@ act_schilling::ActState ActHandler::getState() const
   return mActState;
 }
 
-void ActHandler::setPos(int count, float velCoeff)
+ActHandler::ActRunState ActHandler::getRunState() const
 {
-  if(mConfig.ctrl_mode == MODE_VEL && mActRunState == RUNNING){
-    return;
+  return mActRunState;
+}
+
+QueueState ActHandler::setPos(int count, float velCoeff, uint32_t* ticket)
+{
+  if(ticket){
+    *ticket = 0;
   }
-  if(mActRunState == RUNNING){
-    int i = ang2count(mActBoundaries.min);
-    if(count<i){
-      count = i;
-    }
-    i = ang2count(mActBoundaries.max);
-    if(count>i){
-      count = i;
-    }
+  //enqueuePos ignores position commands in velocity mode
+  if(!hasQueueCapacity(POS_MSGS) || (mConfig.ctrl_mode == MODE_VEL && mActRunState == RUNNING)){
+    return QUEUE_REJECTED;
   }
-  mLastPos.count = 0;
-  enqueueCmdMsg(CMD_CLRERR);
-  enqueueCmdMsg(CMD_SETSHAFTPOS,count,4);
-  setVelocity(double(mConfig.velocity)*velCoeff);
-  enqueueCmdMsg(CMD_CLRERR);
+  enqueuePos(count,velCoeff);
+  startMove(count,ticket);
+  return getQueueState();
+}
+
+QueueState ActHandler::setTrapPos(int count, float velCoeff, uint32_t* ticket)
+{
+  if(ticket){
+    *ticket = 0;
+  }
+  //enqueuePos ignores position commands in velocity mode
+  if(!hasQueueCapacity(POS_MSGS) || (mConfig.ctrl_mode == MODE_VEL && mActRunState == RUNNING)){
+    return QUEUE_REJECTED;
+  }
+  if(mConfig.trap_accel){
+    enqueueTrapPos(count,velCoeff);
+  }
+  else{
+    //without acceleration the device would not move, use the plain position command
+    enqueuePos(count,velCoeff);
+  }
+  startMove(count,ticket);
+  return getQueueState();
 }
 
-void ActHandler::setAnglePos(double ang, double velCoeff)
+void ActHandler::setTrapAccel(int accel)
 {
-  setPos(ang2count(ang),velCoeff);
+  accel = clampTrapAccel(accel);
+  enqueueCmdMsg(CMD_SETTRAPVEL,accel,3);
+  mConfig.trap_accel = accel;
 }
 
-void ActHandler::setVelocity(double vel)
+QueueState ActHandler::setAnglePos(double ang, double velCoeff, uint32_t* ticket)
 {
+  return setPos(ang2count(ang),velCoeff,ticket);
+}
+
+MoveStatus ActHandler::getMoveStatus() const
+{
+  return mMove;
+}
+
+MoveStatus ActHandler::getMoveStatus(uint32_t ticket) const
+{
+  if(ticket == mMove.ticket){
+    return mMove;
+  }
+  MoveStatus other;
+  other.ticket = ticket;
+  //tickets are handed out in increasing order, an earlier one has been replaced by the last move
+  if(ticket && ticket < mMove.ticket){
+    other.state = MOVE_SUPERSEDED;
+  }
+  return other;
+}
+
+bool ActHandler::isMoveCompleted(uint32_t ticket) const
+{
+  MoveState state = getMoveStatus(ticket).state;
+  return state != MOVE_NONE && state != MOVE_ACTIVE;
+}
+
+void ActHandler::setMoveListener(MoveListener* listener)
+{
+  mMoveListener = listener;
+}
+
+QueueState ActHandler::setVelocity(double vel)
+{
+  if(!hasQueueCapacity(1)){
+    return QUEUE_REJECTED;
+  }
+  enqueueVel(vel);
+  return getQueueState();
+}
+
+size_t ActHandler::getQueueDepth() const
+{
+  return mMsgQueue.size();
+}
+
+QueueState ActHandler::getQueueState() const
+{
+  size_t max = mConfig.max_queue_depth;
+  if(!max){
+    return QUEUE_OK;
+  }
+  if(mMsgQueue.size() >= max){
+    return QUEUE_FULL;
+  }
+  if(2*mMsgQueue.size() >= max){
+    return QUEUE_BUSY;
+  }
+  return QUEUE_OK;
+}
+
+void ActHandler::startJog()
+{
+  if(mConfig.ctrl_mode != MODE_VEL || mActRunState != RUNNING || mJogState.active){
+    return;
+  }
+  //the device takes 2 bytes
+  if(mConfig.jog_watchdog < 0){
+    mConfig.jog_watchdog = 0;
+  }
+  if(mConfig.jog_watchdog > ACT_WD_MAX){
+    mConfig.jog_watchdog = ACT_WD_MAX;
+  }
+  enqueueCmdMsg(CMD_SETWD,mConfig.jog_watchdog,2);
+  enqueueVel(0);
+  mJogState.active = true;
+  mJogState.vel = 0;
+  mJogState.last_sent = base::Time::now();
+}
+
+void ActHandler::jog(double vel)
+{
+  //a velocity sent during calibration would override the sweep
+  if(!mJogState.active || mActRunState != RUNNING || mConfig.ctrl_mode != MODE_VEL){
+    return;
+  }
   if(vel<(-ACT_VEL_MAX_RPM)){
     vel = -ACT_VEL_MAX_RPM;
   }  
   if(vel>ACT_VEL_MAX_RPM){
     vel = ACT_VEL_MAX_RPM;
   }
-  enqueueCmdMsg(CMD_SETVEL,ACT_VEL_COEFF*vel,4);
+  base::Time now = base::Time::now();
+  bool changed = fabs(vel-mJogState.vel) > mConfig.jog_deadband || (vel == 0 && mJogState.vel != 0);
+  bool refresh = mConfig.jog_watchdog > 0 && (now-mJogState.last_sent).toMilliseconds() >= mConfig.jog_watchdog/2;
+  if((!changed && !refresh) || !hasQueueCapacity(1)){
+    return;
+  }
+  enqueueVel(vel);
+  mJogState.vel = vel;
+  mJogState.last_sent = now;
+}
+
+void ActHandler::stopJog()
+{
+  if(!mJogState.active){
+    return;
+  }
+  enqueueVel(0);
+  enqueueCmdMsg(CMD_SETWD,0,2);
+  mJogState.active = false;
+  mJogState.vel = 0;
+}
+
+bool ActHandler::isJogging() const
+{
+  return mJogState.active;
 }
 
 void ActHandler::calibrate()
 {
+  //the armed watchdog would stop the sweep
+  stopJog();
   if(mConfig.ctrl_mode == MODE_NONE){
     return;
   }
@@ -113,7 +275,7 @@ void ActHandler::calibrate()
   }
   mActRunState = FINDMIN;
   enqueueCmdMsg(CMD_SETCTRLMODE,MODE_POS,1);
-  setAnglePos(-360,CAL_VEL_COEFF);
+  enqueuePos(ang2count(-360),CAL_VEL_COEFF);
 }
 
 void ActHandler::setControlMode(ControlMode const ctrlMode)
@@ -125,43 +287,123 @@ void ActHandler::setControlMode(ControlMode const ctrlMode)
     return;
   }
   if(ctrlMode == MODE_VEL){
-    setVelocity(0);
+    enqueueVel(0);
+  }
+  else{
+    stopJog();
+  }
+  if(mMove.state == MOVE_ACTIVE){
+    completeMove(MOVE_ABORTED,base::Time::now());
   }
   enqueueCmdMsg(CMD_SETCTRLMODE,ctrlMode,1);
   mConfig.ctrl_mode = ctrlMode;
 }
 
-void ActHandler::requestPosition()
+QueueState ActHandler::requestPosition()
 {
+  if(!hasQueueCapacity(1)){
+    return QUEUE_REJECTED;
+  }
   enqueueCmdMsg(CMD_GETPOS);
+  return getQueueState();
 }
 
-void ActHandler::requestDriveStatus()
+QueueState ActHandler::requestDriveStatus()
 {
+  if(!hasQueueCapacity(1)){
+    return QUEUE_REJECTED;
+  }
   enqueueCmdMsg(CMD_GETDRVSTAT);
+  return getQueueState();
 }
 
-void ActHandler::requestActInfo()
+QueueState ActHandler::requestActInfo()
 {
+  if(!hasQueueCapacity(1)){
+    return QUEUE_REJECTED;
+  }
   enqueueCmdMsg(CMD_GETACTINFO);
+  return getQueueState();
 }
 
 
 ActPosition ActHandler::getPosition()
 {
+  decodePosition();
   return mActPosition;
 }
 
 ActDriveStatus ActHandler::getDriveStatus()
 {
+  decodeDriveStatus();
   return mActDriveStatus;
 }
 
 ActInfo ActHandler::getActInfo()
 {
+  decodeActInfo();
   return mActInfo;
 }
 
+QueueState ActHandler::requestSnapshot()
+{
+  if(!hasQueueCapacity(4)){
+    return QUEUE_REJECTED;
+  }
+  enqueueCmdMsg(CMD_GETSTAT);
+  enqueueCmdMsg(CMD_GETPOS);
+  enqueueCmdMsg(CMD_GETDRVSTAT);
+  enqueueCmdMsg(CMD_GETACTINFO);
+  return getQueueState();
+}
+
+uint32_t ActHandler::collectSnapshot(ActSnapshot& snapshot) const
+{
+  snapshot.fresh = 0;
+  if(snapshot.status_seq != mUpdateSeq.status){
+    snapshot.data = mActData;
+    snapshot.status = mActDevStatus;
+    snapshot.status_seq = mUpdateSeq.status;
+    snapshot.fresh |= SNAP_STATUS;
+  }
+  if(snapshot.pos_seq != mUpdateSeq.pos){
+    decodePosition();
+    snapshot.position = mActPosition;
+    //the encoder status of the device status comes with the GETPOS reply
+    snapshot.status.encoder_status = mActDevStatus.encoder_status;
+    snapshot.pos_seq = mUpdateSeq.pos;
+    snapshot.fresh |= SNAP_POS;
+  }
+  if(snapshot.drive_status_seq != mUpdateSeq.drive_status){
+    decodeDriveStatus();
+    snapshot.drive_status = mActDriveStatus;
+    snapshot.drive_status_seq = mUpdateSeq.drive_status;
+    snapshot.fresh |= SNAP_DRIVE_STATUS;
+  }
+  if(snapshot.act_info_seq != mUpdateSeq.act_info){
+    decodeActInfo();
+    snapshot.act_info = mActInfo;
+    snapshot.act_info_seq = mUpdateSeq.act_info;
+    snapshot.fresh |= SNAP_ACT_INFO;
+  }
+  return snapshot.fresh;
+}
+
+Config const& ActHandler::getConfig() const
+{
+  return mConfig;
+}
+
+HealthMonitor& ActHandler::getHealthMonitor()
+{
+  return mHealthMonitor;
+}
+
+void ActHandler::setPublisher(TelemetryPublisher* publisher)
+{
+  mPublisher = publisher;
+}
+
 ActBoundaries ActHandler::getBoundaries()
 {
   return mActBoundaries;
@@ -206,6 +448,10 @@ bool ActHandler::hasActInfoUpdate()
 
 void ActHandler::setResetState()
 {
+  if(mMove.state == MOVE_ACTIVE){
+    completeMove(MOVE_ABORTED,base::Time::now());
+  }
+  mJogState.active = false;
   mActState.initialized = false;
   mActState.calibrated = false;
   mActRunState = RESET;
@@ -218,6 +464,75 @@ void ActHandler::clearError()
 }
 
 
+bool ActHandler::hasQueueCapacity(size_t msgs) const
+{
+  return !mConfig.max_queue_depth || mMsgQueue.size()+msgs <= (size_t)mConfig.max_queue_depth;
+}
+
+void ActHandler::enqueuePos(int count, float velCoeff)
+{
+  if(mConfig.ctrl_mode == MODE_VEL && mActRunState == RUNNING){
+    return;
+  }
+  if(mActRunState == RUNNING){
+    count = clampPos(count);
+  }
+  mLastPos.count = 0;
+  enqueueCmdMsg(CMD_CLRERR);
+  enqueueCmdMsg(CMD_SETSHAFTPOS,count,4);
+  enqueueVel(double(mConfig.velocity)*velCoeff);
+  enqueueCmdMsg(CMD_CLRERR);
+}
+
+void ActHandler::enqueueTrapPos(int count, float velCoeff)
+{
+  if(mConfig.ctrl_mode == MODE_VEL && mActRunState == RUNNING){
+    return;
+  }
+  if(mActRunState == RUNNING){
+    count = clampPos(count);
+  }
+  //the profile runs up to the velocity set before, so it has to be sent first
+  enqueueCmdMsg(CMD_CLRERR);
+  enqueueVel(double(mConfig.velocity)*velCoeff);
+  enqueueCmdMsg(CMD_SETTRAPPOS,count,4);
+  enqueueCmdMsg(CMD_CLRERR);
+}
+
+int ActHandler::clampPos(int count) const
+{
+  if(count<mMinCount){
+    return mMinCount;
+  }
+  if(count>mMaxCount){
+    return mMaxCount;
+  }
+  return count;
+}
+
+int ActHandler::clampTrapAccel(int accel) const
+{
+  //the device takes 3 bytes, a negative value would wrap to a huge acceleration
+  if(accel<0){
+    return 0;
+  }
+  if(accel>ACT_TRAP_ACCEL_MAX){
+    return ACT_TRAP_ACCEL_MAX;
+  }
+  return accel;
+}
+
+void ActHandler::enqueueVel(double vel)
+{
+  if(vel<(-ACT_VEL_MAX_RPM)){
+    vel = -ACT_VEL_MAX_RPM;
+  }  
+  if(vel>ACT_VEL_MAX_RPM){
+    vel = ACT_VEL_MAX_RPM;
+  }
+  enqueueCmdMsg(CMD_SETVEL,ACT_VEL_COEFF*vel,4);
+}
+
 void ActHandler::enqueueCmdMsg(CMD cmd,int value, int length)
 {
   std::vector<uint8_t> msg(4+length);
@@ -237,7 +552,7 @@ int ActHandler::extractPacket (uint8_t const *buffer, size_t buffer_size) const
 {
   //cout <<"ActHandler extractPacket" <<buffer_size <<endl;
   for (size_t i = 0; i < buffer_size; i++) {
-    if (buffer[i] == ACT_SCHILLING_ACK)
+    if (buffer[i] == ACT_SCHILLING_ACK || buffer[i] == ACT_SCHILLING_NAK)
     {
       if(i){
 	return -i;
@@ -254,6 +569,10 @@ int ActHandler::extractPacket (uint8_t const *buffer, size_t buffer_size) const
 	return 0;
       }
       size_t len = ((act_schilling::raw::MsgHeader*)buffer)->length;
+      //a corrupted length would stall or swallow the following replies, resync on the next byte
+      if(len < 3 || len > 64){
+	return -1;
+      }
       if(buffer_size >= len){
 	//cout <<"returning len " <<len <<endl;
 	return len;
@@ -301,6 +620,8 @@ void ActHandler::checkCS(const char *cData)
 
 void ActHandler::parseReply(const std::vector<uint8_t>* buffer)
 {
+  base::Time time = mRxTime.isNull() ? base::Time::now() : mRxTime;
+  mRxTime = base::Time();
   if((*buffer)[0]==ACT_SCHILLING_ACK){
     //cout <<" ActHandler ACK received" <<endl;  
     mLastCmd = CMD_NONE;
@@ -317,7 +638,8 @@ void ActHandler::parseReply(const std::vector<uint8_t>* buffer)
 	if (((act_schilling::raw::MsgHeader*)(buffer->data()))->length != 0x0C){
 	  throw MarError(MARSTR_DEVREPINV,MARERROR_DEVREPINV);
 	}
-	mActData.time = base::Time::now();
+	mActData.time = time;
+	mActDevStatus.time = time;
 	mActDevStatus.ctrl_status = (*buffer)[2];
 	mActDevStatus.drive_status = (*buffer)[3];
 	mActData.ctrl_mode = (act_schilling::ControlMode)(*buffer)[4];
@@ -329,59 +651,48 @@ void ActHandler::parseReply(const std::vector<uint8_t>* buffer)
 	int16_t vel =  (*buffer)[10];
 	vel |= (*buffer)[9] << 8;
 	mActData.shaft_vel = double(vel)/ACT_VEL_COEFF;
+	mHealthMonitor.updateStatus(mActDevStatus.ctrl_status,mActDevStatus.drive_status,time);
 	if(mActRunState < RUNNING){
 	  checkRunState();
 	}
+	else if(mMove.state == MOVE_ACTIVE){
+	  checkMove();
+	}
 	mLastPos.pos = mActDevStatus.shaft_pos;
+	if(mPublisher){
+	  mPublisher->publish(mActData,mActDevStatus);
+	}
 	mUpdateState.status_update = true;
+	++mUpdateSeq.status;
 	break;
       }
       case CMD_GETPOS:{
 	if (((act_schilling::raw::MsgHeader*)(buffer->data()))->length != 0x0D){
 	  throw MarError(MARSTR_DEVREPINV,MARERROR_DEVREPINV);
 	}
-	mActPosition.time = base::Time::now();
-	mActPosition.ext_encoder_status = (*buffer)[2];
-	mActPosition.ext_abs_pos = (*buffer)[4];
-	mActPosition.ext_abs_pos |= (*buffer)[3] << 8;
-	mActPosition.shaft_pos = (*buffer)[8];
-	mActPosition.shaft_pos |= (*buffer)[7] << 8;
-	mActPosition.shaft_pos |= (*buffer)[6] << 16;
-	mActPosition.shaft_pos |= (*buffer)[5] << 24;
-	mActPosition.shaft_enc_status = (*buffer)[9];
-	mActPosition.shaft_abs_pos = (*buffer)[11];
-	mActPosition.shaft_abs_pos |= (*buffer)[10] << 8;
+	storeRaw(mRawPos,buffer,time);
 	mActDevStatus.encoder_status = (*buffer)[9];
+	mHealthMonitor.updateEncoder(mActDevStatus.encoder_status,time);
 	mUpdateState.pos_update = true;
-	//cout <<"shaft_pos: " <<mActPosition.shaft_pos <<" shaft_abs_pos: " <<mActPosition.shaft_abs_pos <<" ext_abs_pos: " <<mActPosition.ext_abs_pos <<endl;
+	++mUpdateSeq.pos;
 	break;
       }
      case CMD_GETDRVSTAT:{
 	if (((act_schilling::raw::MsgHeader*)(buffer->data()))->length != 0x0C){
 	  throw MarError(MARSTR_DEVREPINV,MARERROR_DEVREPINV);
 	}
-	mActDriveStatus.time = base::Time::now();
-	mActDriveStatus.drive_status = (*buffer)[2];
-	mActDriveStatus.drive_protect_status = (*buffer)[4];
-	mActDriveStatus.drive_protect_status |= (*buffer)[3] << 8;
-	mActDriveStatus.system_protect_status = (*buffer)[6];
-	mActDriveStatus.system_protect_status |= (*buffer)[5] << 8;
-	mActDriveStatus.drive_system_status1 = (*buffer)[8];
-	mActDriveStatus.drive_system_status1 |= (*buffer)[7] << 8;
-	mActDriveStatus.drive_system_status2 = (*buffer)[10];
-	mActDriveStatus.drive_system_status2 |= (*buffer)[9] << 8;
+	storeRaw(mRawDriveStatus,buffer,time);
 	mUpdateState.drive_state_update = true;
+	++mUpdateSeq.drive_status;
 	break;
       }
       case CMD_GETACTINFO:{
 	if (((act_schilling::raw::MsgHeader*)(buffer->data()))->length != 0x0C){
 	  throw MarError(MARSTR_DEVREPINV,MARERROR_DEVREPINV);
 	}
-	mActDriveStatus.time = base::Time::now();
-	mActInfo.serial_no = (*buffer)[7];
-	mActInfo.serial_no |= (*buffer)[6];
-	mActInfo.firmware_rev = (*buffer)[8];
+	storeRaw(mRawActInfo,buffer,time);
 	mUpdateState.act_info_update = true;
+	++mUpdateSeq.act_info;
 	break;
       }
 
@@ -392,14 +703,88 @@ void ActHandler::parseReply(const std::vector<uint8_t>* buffer)
 }
 
 
-int ActHandler::ang2count(double ang)
+void ActHandler::storeRaw(RawReply& raw, const std::vector<uint8_t>* buffer, base::Time const& time)
+{
+  memcpy(raw.data,buffer->data(),((act_schilling::raw::MsgHeader*)(buffer->data()))->length);
+  raw.time = time;
+}
+
+void ActHandler::decodePosition() const
+{
+  if(mRawPos.decoded_seq == mUpdateSeq.pos){
+    return;
+  }
+  const uint8_t *buffer = mRawPos.data;
+  mActPosition.time = mRawPos.time;
+  mActPosition.ext_encoder_status = buffer[2];
+  mActPosition.ext_abs_pos = buffer[4];
+  mActPosition.ext_abs_pos |= buffer[3] << 8;
+  mActPosition.shaft_pos = buffer[8];
+  mActPosition.shaft_pos |= buffer[7] << 8;
+  mActPosition.shaft_pos |= buffer[6] << 16;
+  mActPosition.shaft_pos |= buffer[5] << 24;
+  mActPosition.shaft_enc_status = buffer[9];
+  mActPosition.shaft_abs_pos = buffer[11];
+  mActPosition.shaft_abs_pos |= buffer[10] << 8;
+  mRawPos.decoded_seq = mUpdateSeq.pos;
+}
+
+void ActHandler::decodeDriveStatus() const
+{
+  if(mRawDriveStatus.decoded_seq == mUpdateSeq.drive_status){
+    return;
+  }
+  const uint8_t *buffer = mRawDriveStatus.data;
+  mActDriveStatus.time = mRawDriveStatus.time;
+  mActDriveStatus.drive_status = buffer[2];
+  mActDriveStatus.drive_protect_status = buffer[4];
+  mActDriveStatus.drive_protect_status |= buffer[3] << 8;
+  mActDriveStatus.system_protect_status = buffer[6];
+  mActDriveStatus.system_protect_status |= buffer[5] << 8;
+  mActDriveStatus.drive_system_status1 = buffer[8];
+  mActDriveStatus.drive_system_status1 |= buffer[7] << 8;
+  mActDriveStatus.drive_system_status2 = buffer[10];
+  mActDriveStatus.drive_system_status2 |= buffer[9] << 8;
+  mRawDriveStatus.decoded_seq = mUpdateSeq.drive_status;
+}
+
+void ActHandler::decodeActInfo() const
+{
+  if(mRawActInfo.decoded_seq == mUpdateSeq.act_info){
+    return;
+  }
+  const uint8_t *buffer = mRawActInfo.data;
+  mActInfo.time = mRawActInfo.time;
+  mActInfo.serial_no = buffer[7];
+  mActInfo.serial_no |= buffer[6];
+  mActInfo.firmware_rev = buffer[8];
+  mRawActInfo.decoded_seq = mUpdateSeq.act_info;
+}
+
+//integer division rounded to the nearest value, halves away from zero
+static int64_t divRound(int64_t num, int64_t den)
+{
+  return num >= 0 ? (num + den/2)/den : (num - den/2)/den;
+}
+
+int ActHandler::ang2count(double ang) const
+{
+  return int(floor(ang*mConfig.counts_per_rev/360 + 0.5));
+}
+
+double ActHandler::count2ang(int count) const
+{
+  return double(count)*360/mConfig.counts_per_rev;
+}
+
+int ActHandler::udeg2count(int64_t udeg) const
 {
-  return int(ang*ACT_FULLPOS/360);
+  return divRound(udeg*mConfig.counts_per_rev,int64_t(ACT_UDEG_PER_REV));
 }
 
-double ActHandler::count2ang(int count)
+int64_t ActHandler::count2udeg(int count) const
 {
-  return double(count)*360/ACT_FULLPOS;
+  return divRound(int64_t(count)*ACT_UDEG_PER_REV,mConfig.counts_per_rev);
 }
 
 bool ActHandler::checkMoving(int pos)
@@ -416,6 +801,59 @@ bool ActHandler::checkMoving(int pos)
   return true;  
 }
 
+void ActHandler::startMove(int count, uint32_t* ticket)
+{
+  if(mActRunState != RUNNING || mConfig.ctrl_mode != MODE_POS){
+    return;
+  }
+  base::Time now = base::Time::now();
+  if(mMove.state == MOVE_ACTIVE){
+    completeMove(MOVE_SUPERSEDED,now);
+  }
+  if(!++mMove.ticket){
+    mMove.ticket = 1;
+  }
+  mMove.state = MOVE_ACTIVE;
+  mMove.target = clampPos(count);
+  mMove.start = now;
+  mMove.end = base::Time();
+  mMove.error = mActDevStatus.shaft_pos - mMove.target;
+  mMoveLastPos.pos = mActDevStatus.shaft_pos;
+  mMoveLastPos.count = 0;
+  if(ticket){
+    *ticket = mMove.ticket;
+  }
+}
+
+void ActHandler::checkMove()
+{
+  int pos = mActDevStatus.shaft_pos;
+  mMove.error = pos - mMove.target;
+  if(abs(mMove.error) <= mConfig.move_tolerance){
+    completeMove(MOVE_DONE,mActDevStatus.time);
+    return;
+  }
+  //stalled if the position did not change for 5 status updates, as in checkMoving
+  if(pos == mMoveLastPos.pos){
+    if(++mMoveLastPos.count >= 5){
+      completeMove(MOVE_STALLED,mActDevStatus.time);
+    }
+  }
+  else{
+    mMoveLastPos.count = 0;
+  }
+  mMoveLastPos.pos = pos;
+}
+
+void ActHandler::completeMove(MoveState state, base::Time const& time)
+{
+  mMove.state = state;
+  mMove.end = time;
+  if(mMoveListener){
+    mMoveListener->moveCompleted(mMove);
+  }
+}
+
 void ActHandler::checkRunState()
 {
   //cout <<"checkRunState " <<mActRunState <<endl;
@@ -429,7 +867,7 @@ void ActHandler::checkRunState()
       if(!checkMoving(mActDevStatus.shaft_pos)){
 	mActBoundaries.min = mActDevStatus.shaft_pos;
 	mActRunState = FINDMAX;
-	setAnglePos(360,CAL_VEL_COEFF);
+	enqueuePos(ang2count(360),CAL_VEL_COEFF);
       }
       break;
     }
@@ -437,9 +875,11 @@ void ActHandler::checkRunState()
       if(!checkMoving(mActDevStatus.shaft_pos)){
 	mActRunState = SETZERO;
 	int range = mActDevStatus.shaft_pos - mActBoundaries.min;
-	setPos(range/2+mActBoundaries.min);
+	enqueuePos(range/2+mActBoundaries.min);
 	mActBoundaries.max = count2ang(range/2);
 	mActBoundaries.min = mActBoundaries.max*(-1);		  
+	mMinCount = ang2count(mActBoundaries.min);
+	mMaxCount = ang2count(mActBoundaries.max);
       }
       break;
     }
@@ -447,13 +887,13 @@ void ActHandler::checkRunState()
       if(!checkMoving(mActDevStatus.shaft_pos)){
 	mActRunState = GOHOME; 
 	enqueueCmdMsg(CMD_CLRSHAFTPOS);
-	setPos(ang2count(mConfig.home_pos));
+	enqueuePos(ang2count(mConfig.home_pos));
       }
       break;
     }
     case GOHOME: {
       if(!checkMoving(mActDevStatus.shaft_pos)){
-	setVelocity(0);
+	enqueueVel(0);
 	enqueueCmdMsg(CMD_SETCTRLMODE,mConfig.ctrl_mode,1);
 	mActRunState = RUNNING;
 	mActState.calibrated = true;		
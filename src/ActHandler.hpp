@@ -5,23 +5,38 @@
 #include "ActRaw.hpp"
 #include "Config.hpp"
 #include "ActTypes.hpp"
+#include "HealthMonitor.hpp"
+#include "TelemetryPublisher.hpp"
 
 namespace act_schilling
 {
   
+  /** Interface to get notified about completed moves, see ActHandler::setMoveListener */
+  class MoveListener
+  {
+    public:
+      virtual ~MoveListener() {}
+      /** called when a move is done, stalled, superseded or aborted
+      */
+      virtual void moveCompleted(MoveStatus const& status) = 0;
+  };
+  
   class ActHandler : public base_schilling::Driver
   {
-    enum ActRunState{
-      RESET,
-      INIT,
-      INITIALIZED,
-      FINDMIN,
-      FINDMAX,
-      SETZERO,
-      GOHOME,
-      RUNNING
-    };
+    public:
+      /** run state of the driver, calibration runs through FINDMIN, FINDMAX, SETZERO and GOHOME */
+      enum ActRunState{
+	RESET,
+	INIT,
+	INITIALIZED,
+	FINDMIN,
+	FINDMAX,
+	SETZERO,
+	GOHOME,
+	RUNNING
+      };
   
+    private:
     struct LastPos{
       int pos;
       int count;
@@ -34,6 +49,28 @@ namespace act_schilling
       bool act_info_update;
     };
   
+    struct RawReply{
+      uint8_t data[16];
+      base::Time time;
+      uint32_t decoded_seq;
+      RawReply()
+	: decoded_seq(0)
+      {}
+    };
+  
+    struct JogState{
+      bool active;
+      double vel;
+      base::Time last_sent;
+    };
+  
+    struct UpdateSeq{
+      uint32_t status;
+      uint32_t pos;
+      uint32_t drive_status;
+      uint32_t act_info;
+    };
+  
     public:
       ActHandler(const Config& config = Config());
       /** initializes the device, call this first to start communication with the actuator
@@ -41,9 +78,10 @@ namespace act_schilling
       */
       virtual void initDevice();
       /** request the device status, call this periodically, check response update with hasStatusUpdate and read requested data with getData and getDeviceStatus
-         *
+         * the request is skipped if the message queue is full
+         * @return queue state after enqueueing, QUEUE_REJECTED if the request has been skipped
       */
-      virtual void requestStatus();
+      virtual QueueState requestStatus();
       /** checks if messages to the device are in the queue
          *  @return true: device message queue is empty
       */
@@ -60,23 +98,87 @@ namespace act_schilling
          * only if both flags are set, it is safe to move the actuator, call initDevice and calibrate to get the actuator in the right state to run it (calibration takes some time)
       */      
       ActState getState() const;
+      /** get the run state of the driver, e.g. to report calibration progress
+      */
+      ActRunState getRunState() const;
       /** set actuator position in encoder counts, only comes into effect when actuator is in position mode
        * @arg count: signed encoder count 
        * @arg velCoeff: coefficient to adjust velocity preset by config
+       * @arg ticket: if given, receives the ticket of the move, 0 if the actuator is not calibrated or the command has been rejected
+       * @return queue state after enqueueing, QUEUE_REJECTED if the queue is full or the calibrated actuator is in velocity mode
       */
-      void setPos(int count, float velCoeff = 1);
+      QueueState setPos(int count, float velCoeff = 1, uint32_t* ticket = 0);
       /** set actuator position in angle, only comes into effect when actuator is in position mode
        * @arg count: signed angle
        * @arg velCoeff: coefficient to adjust velocity preset by config
+       * @arg ticket: if given, receives the ticket of the move, see setPos
+       * @return queue state after enqueueing, QUEUE_REJECTED if the queue is full or the calibrated actuator is in velocity mode
+      */
+      QueueState setAnglePos(double ang, double velCoeff = 1, uint32_t* ticket = 0);
+      /** move to a position in encoder counts with the trapezoidal profile of the device, only comes into effect when actuator is in position mode
+       * the actuator ramps with trap_accel of the config up to the velocity preset by config and down to the target on its own
+       * if trap_accel is 0 the profile is disabled and this behaves like setPos
+       * @arg count: signed encoder count
+       * @arg velCoeff: coefficient to adjust velocity preset by config
+       * @arg ticket: if given, receives the ticket of the move, see setPos
+       * @return queue state after enqueueing, QUEUE_REJECTED if the queue is full or the calibrated actuator is in velocity mode
+      */
+      QueueState setTrapPos(int count, float velCoeff = 1, uint32_t* ticket = 0);
+      /** set the acceleration and deceleration of the trapezoidal profile
+       * @arg accel: encoder counts/s^2 from 0 to 0xFFFFFF, 0 disables the profile
+      */
+      void setTrapAccel(int accel);
+      /** get the state of the last move started by setPos, the move is checked on every status update
+      */
+      MoveStatus getMoveStatus() const;
+      /** get the state of the move with the given ticket
+       * @arg ticket: ticket returned by setPos or setTrapPos
+       * @return state of the move, MOVE_SUPERSEDED for the ticket of an earlier move, MOVE_NONE if the ticket is 0 or has not been handed out
       */
-      void setAnglePos(double ang, double velCoeff = 1);
+      MoveStatus getMoveStatus(uint32_t ticket) const;
+      /** @return true if the move with the given ticket has completed, false while it is active or if the ticket is unknown
+      */
+      bool isMoveCompleted(uint32_t ticket) const;
+      /** set a listener notified when a move is completed
+       * @arg listener: listener, has to outlive the handler, NULL to remove it
+      */
+      void setMoveListener(MoveListener* listener);
       /** set actuator velocity, if actuator is in velocity mode, actuator starts moving with specified velocity
        * if actuator is in position mode call comes only into effect if actuator is moving
        * @arg vel: velocity from 0 to 960000 RPM
-       * @arg velCoeff: coefficient to adjust velocity preset by config
+       * @return queue state after enqueueing, QUEUE_REJECTED if the command has been rejected
+      */
+      QueueState setVelocity(double vel);
+      /** @return number of messages waiting in the queue
+      */
+      size_t getQueueDepth() const;
+      /** @return fill state of the message queue in relation to max_queue_depth of the config
+      */
+      QueueState getQueueState() const;
+      /** @arg msgs: number of messages to enqueue
+       * @return true if the message queue has room for msgs messages
+      */
+      bool hasQueueCapacity(size_t msgs) const;
+      //! number of messages enqueued by setPos and setTrapPos
+      static const size_t POS_MSGS = 4;
+      /** start jog mode, only comes into effect when actuator is calibrated and in velocity mode
+       * arms the device watchdog with the jog_watchdog time of the config, clamped to 0xFFFF ms, so the actuator stops if jog is not called in time
+      */
+      void startJog();
+      /** jog with the given velocity, call this every cycle while jogging, has no effect unless the actuator is calibrated and in velocity mode
+       * a new velocity is only sent if it differs more than jog_deadband from the last one sent, or to refresh the watchdog
+       * and if the message queue is not full
+       * @arg vel: velocity from 0 to 960000 RPM
+      */
+      void jog(double vel);
+      /** stop the actuator and leave jog mode, the device watchdog is disabled
       */
-      void setVelocity(double vel);
+      void stopJog();
+      /** @return true if jog mode is active
+      */
+      bool isJogging() const;
       /** start calibration process, if calibration is completed calibration flag of ActState given by getState is set 
+       * ends jog mode
        * during calibration process calling this method has no effect
       */
       void calibrate();
@@ -87,16 +189,19 @@ namespace act_schilling
       void setControlMode(act_schilling::ControlMode const mode);
       /** request Position as defined by Schilling Actuator Command List, usually not needed for operational mode
        * call hasPosUpdate to see if response has been processed and getPosition to receive data
+       * @return queue state after enqueueing, QUEUE_REJECTED if the message queue is full
       */
-      void requestPosition();
+      QueueState requestPosition();
       /** request Drive Status as defined by Schilling Actuator Command List, usually not needed for operational mode
        * call hasDriveStateUpdate to see if response has been processed and getDriveStatus to receive data
+       * @return queue state after enqueueing, QUEUE_REJECTED if the message queue is full
       */
-      void requestDriveStatus();
+      QueueState requestDriveStatus();
       /** request Actuator Info as defined by Schilling Actuator Command List, usually not needed for operational mode
        * call hasActInfoUpdate to see if response has been processed and getActInfo to receive data
+       * @return queue state after enqueueing, QUEUE_REJECTED if the message queue is full
       */
-      void requestActInfo();
+      QueueState requestActInfo();
       /** get Position as defined by Schilling Actuator Command List, usually not needed for operational mode
        * data is valid if requestPosition has been called and hasPosUpdate returned true
       */
@@ -109,6 +214,47 @@ namespace act_schilling
        * data is valid if requestActInfo has been called and hasActInfoUpdate returned true
       */
       ActInfo getActInfo();
+      /** request all telemetry at once, i.e. status, position, drive status and actuator info
+       * call collectSnapshot to receive the data
+       * @return queue state after enqueueing, QUEUE_REJECTED if the message queue has no room for all four requests
+      */
+      QueueState requestSnapshot();
+      /** fill a caller owned snapshot in place with all telemetry updated since it was last collected into this snapshot
+       * parts not updated are left untouched, the update flags checked by the has*Update methods are not affected
+       * @arg snapshot: snapshot to be updated
+       * @return bitmask of SnapshotField, also stored in snapshot.fresh
+      */
+      uint32_t collectSnapshot(ActSnapshot& snapshot) const;
+      /** get the configuration, control mode reflects the last call of setControlMode
+      */
+      Config const& getConfig() const;
+      /** convert angle to encoder counts, rounded to the nearest count
+       * @arg ang: signed angle
+       * @return signed encoder counts
+      */
+      int ang2count(double ang) const;
+      /** convert encoder counts to angle, ang2count(count2ang(count)) returns count within the valid range of counts_per_rev, see Config
+       * @arg count: signed encoder counts
+       * @return signed angle
+      */
+      double count2ang(int count) const;
+      /** convert fixed point angle to encoder counts with integer math, rounded to the nearest count
+       * @arg udeg: signed angle in micro degrees
+       * @return signed encoder counts
+      */
+      int udeg2count(int64_t udeg) const;
+      /** convert encoder counts to fixed point angle with integer math, udeg2count(count2udeg(count)) returns count within the valid range of counts_per_rev, see Config
+       * @arg count: signed encoder counts
+       * @return signed angle in micro degrees, 64 bit as a few revolutions exceed the range of int
+      */
+      int64_t count2udeg(int count) const;
+      /** get the health monitor, fault statistics are updated by every status and position reply
+      */
+      HealthMonitor& getHealthMonitor();
+      /** publish every status update to other processes
+       * @arg publisher: publisher, has to outlive the handler, NULL to stop publishing
+      */
+      void setPublisher(TelemetryPublisher* publisher);
       /** get boundaries, i.e. min and max angles defined by the mechanical assembly of the actuator
       */
       ActBoundaries getBoundaries();
@@ -137,29 +283,55 @@ namespace act_schilling
       */
       void clearError();
     protected:
+      void enqueuePos(int count, float velCoeff = 1);
+      void enqueueVel(double vel);
+      void enqueueTrapPos(int count, float velCoeff = 1);
       void enqueueCmdMsg(raw::CMD cmd,int value = 0, int length = 0);
       int extractPacket (uint8_t const *buffer, size_t buffer_size) const;
       virtual void setCS(char *cData);
       virtual void checkCS(const char *cData);
       virtual void parseReply(const std::vector<uint8_t>* buffer);
-      int ang2count(double ang);
-      double count2ang(int count);
       bool checkMoving(int pos);
       std::deque<std::vector<uint8_t> > mMsgQueue;
       raw::CMD mLastCmd;
+      //! receive time of the reply passed to parseReply, set by the reader, null if unknown
+      base::Time mRxTime;
     private:
       void checkRunState();
+      void checkMove();
+      void completeMove(MoveState state, base::Time const& time);
+      void startMove(int count, uint32_t* ticket);
+      int clampPos(int count) const;
+      int clampTrapAccel(int accel) const;
+      void storeRaw(RawReply& raw, const std::vector<uint8_t>* buffer, base::Time const& time);
+      void decodePosition() const;
+      void decodeDriveStatus() const;
+      void decodeActInfo() const;
       Config mConfig;
       ActData mActData;
       ActDeviceStatus mActDevStatus;
       ActState mActState;
       ActRunState mActRunState;
       LastPos mLastPos;
-      ActPosition mActPosition;
-      ActDriveStatus mActDriveStatus;
-      ActInfo mActInfo;
+      mutable ActPosition mActPosition;
+      mutable ActDriveStatus mActDriveStatus;
+      mutable ActInfo mActInfo;
       ActBoundaries mActBoundaries;
+      //! boundaries in encoder counts, cached when calibration has found them
+      int mMinCount;
+      int mMaxCount;
       UpdateState mUpdateState;
+      UpdateSeq mUpdateSeq;
+      //! last reply frames, decoded on demand
+      mutable RawReply mRawPos;
+      mutable RawReply mRawDriveStatus;
+      mutable RawReply mRawActInfo;
+      JogState mJogState;
+      HealthMonitor mHealthMonitor;
+      MoveStatus mMove;
+      LastPos mMoveLastPos;
+      MoveListener* mMoveListener;
+      TelemetryPublisher* mPublisher;
   };
 }
 
@@ -5,6 +5,7 @@
 #define ACT_SCHILLING_NAK 0x15
 
 #define ACT_FULLPOS  205000
+#define ACT_UDEG_PER_REV 360000000
 
 
 #define ACT_ENC_LIN_ALARM 	0x08
@@ -22,6 +23,8 @@
 #define ACT_DRV_COMM_PHASE	0x20
 #define ACT_VEL_MAX_RPM		0xEA600
 #define ACT_VEL_COEFF		0x10
+#define ACT_WD_MAX		0xFFFF
+#define ACT_TRAP_ACCEL_MAX	0xFFFFFF
 
 
 
@@ -36,7 +39,8 @@ namespace act_schilling {
 	CMD_GETOLDSTAT	= 0x06,
 	CMD_CLRSHAFTPOS	= 0x07,
 	CMD_SETWD	= 0x09,
-	CMD_SETTRAPVEL	= 0x0C,	
+	//! despite the name it sets the acceleration and deceleration of the trapezoidal profile, 3 bytes in encoder counts/s^2
+	CMD_SETTRAPVEL	= 0x0C,
 	CMD_SETTRAPPOS	= 0x0D,	
 	CMD_GETPOS	= 0x20,
 	CMD_GETSTAT	= 0x21,
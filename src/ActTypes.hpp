@@ -15,6 +15,34 @@ namespace act_schilling {
 	MODE_VEL
     };
     
+    /** Fill state of the message queue */
+    enum QueueState{
+      //! message queue has room
+	QUEUE_OK = 0,
+      //! message queue is at least half full, producers should throttle
+	QUEUE_BUSY,
+      //! message queue is full, further commands are rejected
+	QUEUE_FULL,
+      //! command has been rejected, e.g. because the message queue has no room for it, nothing has been enqueued
+	QUEUE_REJECTED
+    };
+    
+    /** State of a move started by setPos */
+    enum MoveState{
+      //! no move has been started, or the ticket is unknown, i.e. 0 or not handed out yet
+	MOVE_NONE = 0,
+      //! actuator is moving to the target
+	MOVE_ACTIVE,
+      //! actuator is in position, i.e. within move_tolerance of the target
+	MOVE_DONE,
+      //! actuator stopped outside of move_tolerance
+	MOVE_STALLED,
+      //! move has been replaced by a newer one, reported for every earlier ticket
+	MOVE_SUPERSEDED,
+      //! move has been aborted by a reset or a control mode change
+	MOVE_ABORTED
+    };
+    
     /** This structure holds operational data **/
     struct ActData {
 	//! timestamp
@@ -28,6 +56,10 @@ namespace act_schilling {
 	ActData()
 	  : time(base::Time::now()),ctrl_mode(MODE_NONE),shaft_ang(0),shaft_vel(0)
 	{}
+	//! construct with a given timestamp, avoids reading the clock
+	explicit ActData(base::Time const& t)
+	  : time(t),ctrl_mode(MODE_NONE),shaft_ang(0),shaft_vel(0)
+	{}
     };
     
     /** This structure holds status data */
@@ -43,7 +75,11 @@ namespace act_schilling {
 	//! shaft position in signed encoder counts
 	int shaft_pos;	
 	ActDeviceStatus() :
-	  time(base::Time::now()),ctrl_status(0),drive_status(0),encoder_status(0)
+	  time(base::Time::now()),ctrl_status(0),drive_status(0),encoder_status(0),shaft_pos(0)
+	{}
+	//! construct with a given timestamp, avoids reading the clock
+	explicit ActDeviceStatus(base::Time const& t) :
+	  time(t),ctrl_status(0),drive_status(0),encoder_status(0),shaft_pos(0)
 	{}
     };
     
@@ -75,6 +111,10 @@ namespace act_schilling {
       ActPosition()
 	: time(base::Time::now()),ext_encoder_status(0),ext_abs_pos(0),shaft_pos(0),shaft_enc_status(0),shaft_abs_pos(0)
       {}
+      //! construct with a given timestamp, avoids reading the clock
+      explicit ActPosition(base::Time const& t)
+	: time(t),ext_encoder_status(0),ext_abs_pos(0),shaft_pos(0),shaft_enc_status(0),shaft_abs_pos(0)
+      {}
     };
     
     /** This structure holds drive status data, usually not necessary for operational mode */
@@ -94,6 +134,10 @@ namespace act_schilling {
       ActDriveStatus()
 	: time(base::Time::now()),drive_status(0),drive_protect_status(0),system_protect_status(0),drive_system_status1(0),drive_system_status2(0)
       {}
+      //! construct with a given timestamp, avoids reading the clock
+      explicit ActDriveStatus(base::Time const& t)
+	: time(t),drive_status(0),drive_protect_status(0),system_protect_status(0),drive_system_status1(0),drive_system_status2(0)
+      {}
     };
     
     /** This structure holds actuator info, usually not necessary for operational mode */
@@ -107,6 +151,10 @@ namespace act_schilling {
       ActInfo()
 	: time(base::Time::now()),serial_no(0),firmware_rev(0)
       {}
+      //! construct with a given timestamp, avoids reading the clock
+      explicit ActInfo(base::Time const& t)
+	: time(t),serial_no(0),firmware_rev(0)
+      {}
     };
     
     /** This structure holds min and max values, evaluated in calibration process */
@@ -120,6 +168,65 @@ namespace act_schilling {
       {}
     };
     
+    /** This structure holds the state of a move started by setPos */
+    struct MoveStatus{
+      //! ticket of the move, 0 if none
+      uint32_t ticket;
+      //! move state
+      MoveState state;
+      //! target in encoder counts, clamped to the boundaries
+      int target;
+      //! time the move has been started
+      base::Time start;
+      //! time the move has been completed, superseded or aborted
+      base::Time end;
+      //! position minus target in encoder counts at the last status update
+      int error;
+      MoveStatus()
+	: ticket(0),state(MOVE_NONE),target(0),error(0)
+      {}
+    };
+    
+    /** Bits of ActSnapshot::fresh, set for each part updated by the last collectSnapshot call */
+    enum SnapshotField{
+      //! data and device status have been updated by a GETSTAT reply
+	SNAP_STATUS = 0x01,
+      //! position has been updated by a GETPOS reply
+	SNAP_POS = 0x02,
+      //! drive status has been updated by a GETDRVSTAT reply
+	SNAP_DRIVE_STATUS = 0x04,
+      //! actuator info has been updated by a GETACTINFO reply
+	SNAP_ACT_INFO = 0x08,
+	SNAP_ALL = 0x0F
+    };
+    
+    /** This structure holds all telemetry of the actuator, filled in place by collectSnapshot */
+    struct ActSnapshot{
+      //! operational data
+      ActData data;
+      //! device status
+      ActDeviceStatus status;
+      //! position data
+      ActPosition position;
+      //! drive status data
+      ActDriveStatus drive_status;
+      //! actuator info
+      ActInfo act_info;
+      //! bitmask of SnapshotField, parts updated by the last collectSnapshot call
+      uint32_t fresh;
+      //! sequence number of the GETSTAT reply data and status are taken from
+      uint32_t status_seq;
+      //! sequence number of the GETPOS reply position is taken from
+      uint32_t pos_seq;
+      //! sequence number of the GETDRVSTAT reply drive_status is taken from
+      uint32_t drive_status_seq;
+      //! sequence number of the GETACTINFO reply act_info is taken from
+      uint32_t act_info_seq;
+      ActSnapshot()
+	: data(base::Time()),status(base::Time()),position(base::Time()),drive_status(base::Time()),act_info(base::Time()),
+	  fresh(0),status_seq(0),pos_seq(0),drive_status_seq(0),act_info_seq(0)
+      {}
+    };
     
 }
 
@@ -0,0 +1,244 @@
+#include "BringUp.hpp"
+#include <stdexcept>
+
+using namespace act_schilling;
+
+BringUp::BringUp(base::Time const& timeout, int max_errors)
+  : mTimeout(timeout), mMaxErrors(max_errors)
+{
+}
+
+BringUp::~BringUp()
+{
+  for(size_t i=0;i<mAxes.size();i++){
+    if(mAxes[i].owned){
+      delete mAxes[i].driver;
+    }
+  }
+}
+
+size_t BringUp::addAxis(std::string const& uri, Config const& config, int interlock)
+{
+  Axis axis;
+  axis.driver = new Driver(config);
+  axis.owned = true;
+  axis.uri = uri;
+  axis.interlock = interlock;
+  axis.errors = 0;
+  mAxes.push_back(axis);
+  return mAxes.size()-1;
+}
+
+size_t BringUp::addAxis(Driver* driver, int interlock)
+{
+  Axis axis;
+  axis.driver = driver;
+  axis.owned = false;
+  axis.interlock = interlock;
+  axis.errors = 0;
+  mAxes.push_back(axis);
+  return mAxes.size()-1;
+}
+
+bool BringUp::step()
+{
+  if(mStart.isNull()){
+    mStart = base::Time::now();
+    //check all interlocks before any device is opened, a cycle would otherwise wait for the timeout
+    for(size_t i=0;i<mAxes.size();i++){
+      std::string error = checkInterlock(i);
+      if(!error.empty()){
+	mAxes[i].progress.start = mStart;
+	fail(i,error);
+      }
+    }
+    for(size_t i=0;i<mAxes.size();i++){
+      if(mAxes[i].progress.phase != BRINGUP_FAILED){
+	start(i);
+      }
+    }
+  }
+  //write to all idle axes first, so the replies of all links are pending at the same time
+  //an axis still waiting for a reply must not get the next command, its reply would be parsed as the reply to that command
+  for(size_t i=0;i<mAxes.size();i++){
+    Axis& axis = mAxes[i];
+    if(axis.progress.phase == BRINGUP_DONE || axis.progress.phase == BRINGUP_FAILED || !axis.driver->isIdle()){
+      continue;
+    }
+    try{
+      if(!axis.driver->getQueueDepth()){
+	axis.driver->requestStatus();
+      }
+      axis.driver->writeNext();
+    }
+    catch(std::exception& e){
+      fail(i,e.what());
+    }
+  }
+  bool finished = true;
+  for(size_t i=0;i<mAxes.size();i++){
+    Axis& axis = mAxes[i];
+    if(axis.progress.phase == BRINGUP_DONE || axis.progress.phase == BRINGUP_FAILED){
+      continue;
+    }
+    try{
+      if(!axis.driver->isIdle()){
+	axis.driver->read();
+      }
+    }
+    catch(std::exception& e){
+      if(++axis.errors >= mMaxErrors){
+	fail(i,e.what());
+	continue;
+      }
+      //drop the failed reply, the status is requested again in the next round
+      axis.driver->clearReadBuffer();
+    }
+    update(i);
+    if(axis.progress.phase != BRINGUP_DONE && axis.progress.phase != BRINGUP_FAILED){
+      finished = false;
+    }
+  }
+  if(finished && mEnd.isNull()){
+    mEnd = base::Time::now();
+  }
+  return finished;
+}
+
+bool BringUp::run()
+{
+  while(!step()){
+  }
+  for(size_t i=0;i<mAxes.size();i++){
+    if(mAxes[i].progress.phase != BRINGUP_DONE){
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t BringUp::getAxisCount() const
+{
+  return mAxes.size();
+}
+
+AxisProgress const& BringUp::getProgress(size_t axis) const
+{
+  return mAxes.at(axis).progress;
+}
+
+Driver& BringUp::getDriver(size_t axis)
+{
+  return *mAxes.at(axis).driver;
+}
+
+base::Time BringUp::getTotalTime() const
+{
+  if(mStart.isNull()){
+    return base::Time();
+  }
+  if(mEnd.isNull()){
+    return base::Time::now() - mStart;
+  }
+  return mEnd - mStart;
+}
+
+void BringUp::start(size_t i)
+{
+  Axis& axis = mAxes[i];
+  axis.progress.start = base::Time::now();
+  try{
+    if(axis.owned){
+      axis.driver->openURI(axis.uri);
+    }
+    axis.driver->setResetState();
+    axis.driver->clearReadBuffer();
+    axis.driver->initDevice();
+  }
+  catch(std::exception& e){
+    fail(i,e.what());
+    return;
+  }
+  setPhase(i,BRINGUP_INIT);
+}
+
+std::string BringUp::checkInterlock(size_t i) const
+{
+  int interlock = mAxes[i].interlock;
+  if(interlock < -1 || interlock >= (int)mAxes.size() || interlock == (int)i){
+    return "invalid interlock axis";
+  }
+  //follow the chain, without cycle it ends after at most one step per axis
+  //an axis waiting for a cycle it is not part of fails when the cycle fails
+  for(size_t n=0;n<mAxes.size() && interlock >= 0 && interlock < (int)mAxes.size();n++){
+    if(interlock == (int)i){
+      return "interlock cycle";
+    }
+    interlock = mAxes[interlock].interlock;
+  }
+  return "";
+}
+
+void BringUp::fail(size_t i, std::string const& error)
+{
+  mAxes[i].progress.error = error;
+  mAxes[i].progress.end = base::Time::now();
+  setPhase(i,BRINGUP_FAILED);
+}
+
+void BringUp::update(size_t i)
+{
+  Axis& axis = mAxes[i];
+  Driver& driver = *axis.driver;
+  if(driver.getRunState() != axis.progress.run_state){
+    axis.progress.run_state = driver.getRunState();
+    progress(i,axis.progress);
+  }
+  ActState state = driver.getState();
+  switch(axis.progress.phase){
+    case BRINGUP_INIT:
+      if(!state.initialized){
+	break;
+      }
+      if(driver.getConfig().ctrl_mode == MODE_NONE){
+	//calibrate has no effect without control mode
+	axis.progress.end = base::Time::now();
+	setPhase(i,BRINGUP_DONE);
+	return;
+      }
+      setPhase(i,BRINGUP_WAITING);
+      //fall through
+    case BRINGUP_WAITING:
+      if(axis.interlock >= 0){
+	BringUpPhase interlock = mAxes[axis.interlock].progress.phase;
+	if(interlock == BRINGUP_FAILED){
+	  fail(i,"interlock axis failed");
+	  return;
+	}
+	if(interlock != BRINGUP_DONE){
+	  break;
+	}
+      }
+      driver.calibrate();
+      setPhase(i,BRINGUP_CALIBRATING);
+      break;
+    case BRINGUP_CALIBRATING:
+      if(state.calibrated){
+	axis.progress.end = base::Time::now();
+	setPhase(i,BRINGUP_DONE);
+	return;
+      }
+      break;
+    default:
+      return;
+  }
+  if(base::Time::now() - axis.progress.start > mTimeout){
+    fail(i,"timeout");
+  }
+}
+
+void BringUp::setPhase(size_t i, BringUpPhase phase)
+{
+  mAxes[i].progress.phase = phase;
+  progress(i,mAxes[i].progress);
+}
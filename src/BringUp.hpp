@@ -0,0 +1,119 @@
+#ifndef _ACT_SCHILLING_BRINGUP_HPP_
+#define _ACT_SCHILLING_BRINGUP_HPP_
+
+#include <string>
+#include <vector>
+#include "Driver.hpp"
+
+namespace act_schilling
+{
+
+  /** Bring-up phase of an axis */
+  enum BringUpPhase{
+    //! axis has not been started yet
+    BRINGUP_IDLE,
+    //! device is being initialized
+    BRINGUP_INIT,
+    //! device is initialized, calibration waits for the interlock axis
+    BRINGUP_WAITING,
+    //! device is being calibrated
+    BRINGUP_CALIBRATING,
+    //! device is initialized and calibrated
+    BRINGUP_DONE,
+    //! bring-up failed, see error
+    BRINGUP_FAILED
+  };
+
+  /** This structure holds the bring-up progress of one axis */
+  struct AxisProgress{
+    //! bring-up phase
+    BringUpPhase phase;
+    //! run state of the driver, shows the calibration stage
+    ActHandler::ActRunState run_state;
+    //! time the axis has been started
+    base::Time start;
+    //! time the axis has been done or failed
+    base::Time end;
+    //! error message if failed
+    std::string error;
+    AxisProgress()
+      : phase(BRINGUP_IDLE),run_state(ActHandler::RESET)
+    {}
+  };
+
+  /** Opens, initializes and calibrates several actuators concurrently
+   * all axes are polled round robin, so the calibration sweeps run in parallel,
+   * an axis with an interlock starts calibrating only after the interlock axis is done
+  */
+  class BringUp
+  {
+    struct Axis{
+      Driver* driver;
+      bool owned;
+      std::string uri;
+      int interlock;
+      int errors;
+      AxisProgress progress;
+    };
+  
+    public:
+      /** @arg timeout: max bring-up time per axis
+       * @arg max_errors: number of read errors after which an axis fails
+      */
+      BringUp(base::Time const& timeout = base::Time::fromSeconds(600), int max_errors = 3);
+      virtual ~BringUp();
+      /** add an axis opened by the bring-up
+       * @arg uri: device uri, e.g. serial:///dev/ttyS0:9600
+       * @arg config: driver config
+       * @arg interlock: index of the axis which has to be calibrated first, -1 for none
+       * @return axis index
+      */
+      size_t addAxis(std::string const& uri, Config const& config = Config(), int interlock = -1);
+      /** add an already opened driver, it is not deleted by the bring-up
+       * @arg driver: driver, has to outlive the bring-up
+       * @arg interlock: index of the axis which has to be calibrated first, -1 for none
+       * @return axis index
+      */
+      size_t addAxis(Driver* driver, int interlock = -1);
+      /** run one polling round over all axes, opens and starts the axes on the first call
+       * the first call fails axes with an invalid or cyclic interlock before any device is opened
+       * @return true if all axes are done or failed
+      */
+      bool step();
+      /** run the bring-up until all axes are done or failed
+       * @return true if all axes are done
+      */
+      bool run();
+      /** @return number of axes
+      */
+      size_t getAxisCount() const;
+      /** get the progress of an axis
+      */
+      AxisProgress const& getProgress(size_t axis) const;
+      /** get the driver of an axis, e.g. to hand it over after bring-up
+      */
+      Driver& getDriver(size_t axis);
+      /** @return time from the first step until all axes are done or failed, or until now if still running
+      */
+      base::Time getTotalTime() const;
+    protected:
+      /** called whenever the phase or the run state of an axis changes
+      */
+      virtual void progress(size_t axis, AxisProgress const& progress) {}
+    private:
+      void start(size_t axis);
+      /** @return error if the interlock of the axis is out of range or part of a cycle, empty otherwise
+      */
+      std::string checkInterlock(size_t axis) const;
+      void fail(size_t axis, std::string const& error);
+      void update(size_t axis);
+      void setPhase(size_t axis, BringUpPhase phase);
+      std::vector<Axis> mAxes;
+      base::Time mTimeout;
+      int mMaxErrors;
+      base::Time mStart;
+      base::Time mEnd;
+  };
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define _ACT_SCHILLING_CONFIG_HPP_
 
 #include "ActTypes.hpp"
+#include "ActRaw.hpp"
 
 namespace act_schilling
 {
@@ -11,11 +12,29 @@ struct Config
         int velocity;	
 	ControlMode ctrl_mode;
 	int home_pos;
+	//! velocity change below which jog does not send a new velocity
+	double jog_deadband;
+	//! device watchdog timeout in ms while jogging, the actuator stops if no command arrives in time, 0 disables the watchdog, at most 65535
+	int jog_watchdog;
+	//! max number of queued messages, commands exceeding it are rejected, 0 for no limit
+	int max_queue_depth;
+	//! encoder counts per shaft revolution, depends on the gearing, from 1 to 360000000, ACT_FULLPOS is used outside this range
+	int counts_per_rev;
+	//! max distance to the target in encoder counts at which a move is complete
+	int move_tolerance;
+	//! acceleration and deceleration of the onboard trapezoidal profile in encoder counts/s^2, 0 disables the profile
+	int trap_accel;
 	
 	Config()
             : velocity(1250),
 	      ctrl_mode(MODE_VEL),
-	      home_pos(0)
+	      home_pos(0),
+	      jog_deadband(10),
+	      jog_watchdog(500),
+	      max_queue_depth(64),
+	      counts_per_rev(ACT_FULLPOS),
+	      move_tolerance(50),
+	      trap_accel(0)
         {   
         }   
 
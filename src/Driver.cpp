@@ -7,7 +7,8 @@ using namespace act_schilling;
 using namespace std;
 
 Driver::Driver(const Config& config)
-    : ActHandler(config)
+    : ActHandler(config), mTransport(0),
+      mRoundTrip(base::Time::fromMilliseconds(20))
 {
 }
 
@@ -17,10 +18,16 @@ void Driver::read()
 
     try {
                     //cout << "read: try readPacket" << endl;
-        int size = readPacket(&buffer[0], buffer.size());
+        int size = readFrame(&buffer[0], buffer.size());
                     //cout << "read: readPacket: " << size << endl;
  
 	if(size){
+	  mRxTime = base::Time::now();
+	  if (!mWriteTime.isNull()) {
+	    //moving average over about 8 replies
+	    mRoundTrip = base::Time::fromMicroseconds((mRoundTrip.toMicroseconds()*7 + (mRxTime-mWriteTime).toMicroseconds())/8);
+	    mWriteTime = base::Time();
+	  }
 	  /*char sz[128];
 	  *sz = 0;
 	  for(int i=0;i<size;i++){
@@ -47,16 +54,19 @@ void Driver::writeNext()
 	  sprintf(sz+strlen(sz),"%02x | ",msg[i]);
 	}	    
 	cout <<"Actuator write: " <<sz <<endl;*/
-    	writePacket(msg.data(), msg.size());
+	mWriteTime = base::Time::now();
+    	writeFrame(msg.data(), msg.size());
     }
 }
 
 void Driver::clearReadBuffer()
 {
     std::vector<uint8_t>    buffer(1024);
+    mRxBuffer.clear();
+    mLastCmd = act_schilling::raw::CMD_NONE;
 
     try {
-      int size = readPacket(&buffer[0], buffer.size(),base::Time::fromSeconds(0.05));
+      int size = readFrame(&buffer[0], buffer.size(),base::Time::fromSeconds(0.05));
       /*if(size){
 	  char sz[128];
 	  *sz = 0;
@@ -70,3 +80,79 @@ void Driver::clearReadBuffer()
     }
 }
 
+base::Time Driver::getDrainTime() const
+{
+    return base::Time::fromMicroseconds(mRoundTrip.toMicroseconds()*getQueueDepth());
+}
+
+MoveStatus Driver::waitMove(uint32_t ticket, base::Time const& timeout)
+{
+    base::Time start = base::Time::now();
+    MoveStatus status = getMoveStatus(ticket);
+    while (status.state == MOVE_ACTIVE && base::Time::now() - start < timeout) {
+        if (!getQueueDepth()) {
+            requestStatus();
+        }
+        //a pending reply would be parsed as the reply to the next command
+        if (isIdle()) {
+            writeNext();
+        }
+        if (!isIdle()) {
+            read();
+        }
+        status = getMoveStatus(ticket);
+    }
+    return status;
+}
+
+base::Time Driver::getRoundTrip() const
+{
+    return mRoundTrip;
+}
+
+void Driver::setTransport(Transport* transport)
+{
+    mTransport = transport;
+    mRxBuffer.clear();
+}
+
+int Driver::readFrame(uint8_t* buffer, int buffer_size, base::Time const& timeout)
+{
+    if (mTransport) {
+        //frame the byte stream with extractPacket, as the serial I/O does
+        for (;;) {
+            while (!mRxBuffer.empty()) {
+                int result = extractPacket(&mRxBuffer[0], mRxBuffer.size());
+                if (result > 0) {
+                    int size = result < buffer_size ? result : buffer_size;
+                    memcpy(buffer, &mRxBuffer[0], size);
+                    mRxBuffer.erase(mRxBuffer.begin(), mRxBuffer.begin() + result);
+                    return size;
+                }
+                if (result == 0) {
+                    break;
+                }
+                mRxBuffer.erase(mRxBuffer.begin(), mRxBuffer.begin() - result);
+            }
+            uint8_t chunk[256];
+            int size = mTransport->readBytes(chunk, sizeof(chunk), timeout);
+            if (!size) {
+                throw TransportTimeout();
+            }
+            mRxBuffer.insert(mRxBuffer.end(), chunk, chunk + size);
+        }
+    }
+    if (timeout.isNull()) {
+        return readPacket(buffer, buffer_size);
+    }
+    return readPacket(buffer, buffer_size, timeout);
+}
+
+void Driver::writeFrame(uint8_t const* buffer, int buffer_size)
+{
+    if (mTransport) {
+        mTransport->writeBytes(buffer, buffer_size);
+        return;
+    }
+    writePacket(buffer, buffer_size);
+}
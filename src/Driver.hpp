@@ -2,6 +2,7 @@
 #define _ACT_SCHILLING_DRIVER_HPP_
 
 #include "ActHandler.hpp"
+#include "Transport.hpp"
 
 
 namespace act_schilling
@@ -20,8 +21,42 @@ namespace act_schilling
 	    */
 	    void writeNext();
 	    
+	    /** discard received data and the reply still pending, e.g. after a read error, so the next command can be written
+	    */
 	    void clearReadBuffer();
 	    
+	    /** get the estimated time until all queued messages have been sent and answered
+	    * based on the measured round trip time, producers can use it to throttle
+	    * */
+	    base::Time getDrainTime() const;
+	    
+	    /** block until the move with the given ticket is completed, requests the status while waiting
+	    * use this only if nothing else drives the I/O of the driver
+	    * @arg ticket: ticket returned by setPos
+	    * @arg timeout: max time to wait
+	    * @return state of the move, MOVE_ACTIVE if the timeout expired, at once if the move has been superseded or the ticket is unknown
+	    * throws std::runtime_error
+	    * */
+	    MoveStatus waitMove(uint32_t ticket, base::Time const& timeout);
+	    
+	    /** get the mean round trip time of a command, 20ms until the first reply has been received
+	    * */
+	    base::Time getRoundTrip() const;
+	    
+	    /** use a transport instead of the I/O of the driver, e.g. MockTransport for tests
+	    * @arg transport: transport to use, has to outlive the driver, NULL to switch back to the driver I/O
+	    * */
+	    void setTransport(Transport* transport);
+	    
+	 private:
+	    int readFrame(uint8_t* buffer, int buffer_size, base::Time const& timeout = base::Time());
+	    void writeFrame(uint8_t const* buffer, int buffer_size);
+	    Transport* mTransport;
+	    //! bytes read from the transport not yet extracted into a packet
+	    std::vector<uint8_t> mRxBuffer;
+	    base::Time mWriteTime;
+	    base::Time mRoundTrip;
+	    
 	    		
 			
 	};
@@ -0,0 +1,118 @@
+#include "HealthMonitor.hpp"
+#include "ActRaw.hpp"
+
+using namespace act_schilling;
+
+static const uint8_t CTRL_MASKS[] = {ACT_CTRL_WD_TIME,ACT_CTRL_EXT_ENC_MAG,ACT_CTRL_EXT_ENC_COMM,
+  ACT_CTRL_SH_ENC_MAG,ACT_CTRL_WATER,ACT_CTRL_SH_ENC_COMM};
+static const uint8_t DRV_MASKS[] = {ACT_DRV_CMD_INC,ACT_DRV_CMD_INV,ACT_DRV_FRAME_ERR,
+  ACT_DRV_VOLT_TEMP,ACT_DRV_COMM_PHASE};
+static const uint8_t ENC_MASKS[] = {ACT_ENC_LIN_ALARM,ACT_ENC_RANGE_ERR};
+
+static const char* FAULT_NAMES[] = {"CTRL_WD_TIME","CTRL_EXT_ENC_MAG","CTRL_EXT_ENC_COMM",
+  "CTRL_SH_ENC_MAG","CTRL_WATER","CTRL_SH_ENC_COMM","DRV_CMD_INC","DRV_CMD_INV",
+  "DRV_FRAME_ERR","DRV_VOLT_TEMP","DRV_COMM_PHASE","ENC_LIN_ALARM","ENC_RANGE_ERR"};
+
+HealthMonitor::HealthMonitor(size_t max_events)
+  : mMaxEvents(max_events), mSamples(0), mDropped(0)
+{
+}
+
+void HealthMonitor::updateStatus(uint8_t ctrl_status, uint8_t drive_status, base::Time const& time)
+{
+  mSamples++;
+  update(FAULT_CTRL_WD_TIME,FAULT_CTRL_SH_ENC_COMM,CTRL_MASKS,ctrl_status,time);
+  update(FAULT_DRV_CMD_INC,FAULT_DRV_COMM_PHASE,DRV_MASKS,drive_status,time);
+}
+
+void HealthMonitor::updateEncoder(uint8_t encoder_status, base::Time const& time)
+{
+  update(FAULT_ENC_LIN_ALARM,FAULT_ENC_RANGE_ERR,ENC_MASKS,encoder_status,time);
+}
+
+FaultStats const& HealthMonitor::getStats(Fault fault) const
+{
+  return mStats[fault];
+}
+
+unsigned int HealthMonitor::getSampleCount() const
+{
+  return mSamples;
+}
+
+bool HealthMonitor::hasActiveFault() const
+{
+  for(int i=0;i<FAULT_COUNT;i++){
+    if(mStats[i].active){
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HealthMonitor::popEvent(FaultEvent& event)
+{
+  if(mEvents.empty()){
+    return false;
+  }
+  event = mEvents.front();
+  mEvents.pop_front();
+  return true;
+}
+
+unsigned int HealthMonitor::getDroppedEvents() const
+{
+  return mDropped;
+}
+
+void HealthMonitor::reset()
+{
+  for(int i=0;i<FAULT_COUNT;i++){
+    mStats[i] = FaultStats();
+  }
+  mEvents.clear();
+  mSamples = 0;
+  mDropped = 0;
+}
+
+const char* HealthMonitor::getFaultName(Fault fault)
+{
+  if(fault < 0 || fault >= FAULT_COUNT){
+    return "UNKNOWN";
+  }
+  return FAULT_NAMES[fault];
+}
+
+void HealthMonitor::update(Fault first, Fault last, uint8_t const* masks, uint8_t bits, base::Time const& time)
+{
+  for(int f=first;f<=last;f++){
+    FaultStats& stats = mStats[f];
+    bool active = bits & masks[f-first];
+    if(active){
+      stats.samples++;
+      stats.last_seen = time;
+    }
+    if(active == stats.active){
+      continue;
+    }
+    stats.active = active;
+    if(active){
+      stats.raised++;
+      if(stats.first_seen.isNull()){
+	stats.first_seen = time;
+      }
+    }
+    if(!mMaxEvents){
+      continue;
+    }
+    if(mEvents.size() >= mMaxEvents){
+      mEvents.pop_front();
+      mDropped++;
+    }
+    FaultEvent event;
+    event.time = time;
+    event.fault = (Fault)f;
+    event.raised = active;
+    mEvents.push_back(event);
+  }
+}
@@ -0,0 +1,113 @@
+#ifndef _ACT_SCHILLING_HEALTHMONITOR_HPP_
+#define _ACT_SCHILLING_HEALTHMONITOR_HPP_
+
+#include <deque>
+#include <base/Time.hpp>
+#include "ActTypes.hpp"
+
+namespace act_schilling
+{
+
+  /** Faults decoded from the status bytes */
+  enum Fault{
+    //! controller watchdog time out
+    FAULT_CTRL_WD_TIME = 0,
+    //! external encoder magnet
+    FAULT_CTRL_EXT_ENC_MAG,
+    //! external encoder communication
+    FAULT_CTRL_EXT_ENC_COMM,
+    //! shaft encoder magnet
+    FAULT_CTRL_SH_ENC_MAG,
+    //! water ingress
+    FAULT_CTRL_WATER,
+    //! shaft encoder communication
+    FAULT_CTRL_SH_ENC_COMM,
+    //! incomplete command
+    FAULT_DRV_CMD_INC,
+    //! invalid command
+    FAULT_DRV_CMD_INV,
+    //! frame error
+    FAULT_DRV_FRAME_ERR,
+    //! voltage or temperature
+    FAULT_DRV_VOLT_TEMP,
+    //! commutation phase
+    FAULT_DRV_COMM_PHASE,
+    //! encoder linearity alarm
+    FAULT_ENC_LIN_ALARM,
+    //! encoder range error
+    FAULT_ENC_RANGE_ERR,
+    FAULT_COUNT
+  };
+
+  /** This structure holds the statistics of one fault */
+  struct FaultStats{
+    //! flag set while the fault bit is set
+    bool active;
+    //! number of times the fault has been raised
+    unsigned int raised;
+    //! number of status samples with the fault bit set
+    unsigned int samples;
+    //! time the fault has been raised first, null if never
+    base::Time first_seen;
+    //! time the fault bit has been seen last, null if never
+    base::Time last_seen;
+    FaultStats()
+      : active(false),raised(0),samples(0)
+    {}
+  };
+
+  /** This structure holds a fault edge */
+  struct FaultEvent{
+    //! time of the status sample
+    base::Time time;
+    //! fault
+    Fault fault;
+    //! true if the fault has been raised, false if cleared
+    bool raised;
+  };
+
+  class HealthMonitor
+  {
+    public:
+      /** @arg max_events: number of fault edges kept until they are fetched with popEvent, older ones are dropped
+      */
+      HealthMonitor(size_t max_events = 64);
+      /** update with the control and drive status bytes of a GETSTAT reply
+      */
+      void updateStatus(uint8_t ctrl_status, uint8_t drive_status, base::Time const& time);
+      /** update with the shaft encoder status byte of a GETPOS reply
+      */
+      void updateEncoder(uint8_t encoder_status, base::Time const& time);
+      /** get the statistics of a fault
+      */
+      FaultStats const& getStats(Fault fault) const;
+      /** @return number of status samples processed
+      */
+      unsigned int getSampleCount() const;
+      /** @return true if a fault is active
+      */
+      bool hasActiveFault() const;
+      /** get the oldest fault edge not fetched yet
+       * @return false if there is none
+      */
+      bool popEvent(FaultEvent& event);
+      /** @return number of fault edges dropped because they have not been fetched in time
+      */
+      unsigned int getDroppedEvents() const;
+      /** reset all statistics and events
+      */
+      void reset();
+      /** @return name of the fault
+      */
+      static const char* getFaultName(Fault fault);
+    private:
+      void update(Fault first, Fault last, uint8_t const* masks, uint8_t bits, base::Time const& time);
+      FaultStats mStats[FAULT_COUNT];
+      std::deque<FaultEvent> mEvents;
+      size_t mMaxEvents;
+      unsigned int mSamples;
+      unsigned int mDropped;
+  };
+}
+
+#endif
@@ -0,0 +1,93 @@
+#include "LatencyStats.hpp"
+#include <string.h>
+
+using namespace act_schilling;
+
+LatencyStats::LatencyStats()
+{
+  reset();
+}
+
+void LatencyStats::add(base::Time const& latency)
+{
+  int64_t us = latency.toMicroseconds();
+  if(us < 0){
+    us = 0;
+  }
+  mBuckets[bucket(us)]++;
+  mCount++;
+  mSum += us;
+  if((uint64_t)us > mMax){
+    mMax = us;
+  }
+}
+
+uint64_t LatencyStats::getCount() const
+{
+  return mCount;
+}
+
+base::Time LatencyStats::getMean() const
+{
+  if(!mCount){
+    return base::Time();
+  }
+  return base::Time::fromMicroseconds(mSum/mCount);
+}
+
+base::Time LatencyStats::getMax() const
+{
+  return base::Time::fromMicroseconds(mMax);
+}
+
+base::Time LatencyStats::getPercentile(double p) const
+{
+  if(!mCount){
+    return base::Time();
+  }
+  uint64_t rank = uint64_t(p/100*mCount);
+  if(rank >= mCount){
+    rank = mCount-1;
+  }
+  uint64_t n = 0;
+  for(int i=0;i<BUCKETS;i++){
+    n += mBuckets[i];
+    if(n > rank){
+      uint64_t limit = bucketLimit(i);
+      return base::Time::fromMicroseconds(limit < mMax ? limit : mMax);
+    }
+  }
+  return getMax();
+}
+
+void LatencyStats::reset()
+{
+  memset(mBuckets,0,sizeof(mBuckets));
+  mCount = 0;
+  mSum = 0;
+  mMax = 0;
+}
+
+int LatencyStats::bucket(uint64_t us)
+{
+  //values below SUB_BUCKETS get one bucket each, above that SUB_BUCKETS per power of two
+  if(us < (uint64_t)SUB_BUCKETS){
+    return us;
+  }
+  int exp = 0;
+  while((us >> exp) >= (uint64_t)(2*SUB_BUCKETS)){
+    exp++;
+  }
+  int b = (exp+1)*SUB_BUCKETS + int(us >> exp) - SUB_BUCKETS;
+  return b < BUCKETS ? b : BUCKETS-1;
+}
+
+uint64_t LatencyStats::bucketLimit(int b)
+{
+  if(b < SUB_BUCKETS){
+    return b;
+  }
+  int exp = b/SUB_BUCKETS - 1;
+  uint64_t mant = b%SUB_BUCKETS + SUB_BUCKETS;
+  return ((mant+1) << exp) - 1;
+}
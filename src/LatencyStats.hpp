@@ -0,0 +1,48 @@
+#ifndef _ACT_SCHILLING_LATENCYSTATS_HPP_
+#define _ACT_SCHILLING_LATENCYSTATS_HPP_
+
+#include <stdint.h>
+#include <base/Time.hpp>
+
+namespace act_schilling
+{
+
+  /** Latency histogram with constant memory, percentiles are accurate to 1/8 of a power of two
+  */
+  class LatencyStats
+  {
+    public:
+      LatencyStats();
+      /** add a latency sample
+      */
+      void add(base::Time const& latency);
+      /** @return number of samples
+      */
+      uint64_t getCount() const;
+      /** @return mean latency
+      */
+      base::Time getMean() const;
+      /** @return max latency
+      */
+      base::Time getMax() const;
+      /** get a percentile
+       * @arg p: percentile from 0 to 100
+       * @return upper bound of the histogram bucket holding the percentile, null if there are no samples
+      */
+      base::Time getPercentile(double p) const;
+      /** remove all samples
+      */
+      void reset();
+    private:
+      static const int SUB_BUCKETS = 8;
+      static const int BUCKETS = 40*SUB_BUCKETS;
+      static int bucket(uint64_t us);
+      static uint64_t bucketLimit(int bucket);
+      uint64_t mBuckets[BUCKETS];
+      uint64_t mCount;
+      uint64_t mSum;
+      uint64_t mMax;
+  };
+}
+
+#endif
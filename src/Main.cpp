@@ -1,6 +1,365 @@
 #include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdlib.h>
+#include <string.h>
+#include "Driver.hpp"
+#include "BringUp.hpp"
+#include "SimTransport.hpp"
+#include "LatencyStats.hpp"
+
+using namespace act_schilling;
+using namespace std;
+
+class CliDriver : public Driver
+{
+  public:
+    CliDriver(const Config& config)
+      : Driver(config)
+    {}
+    /** queue a single GETSTAT, used by probe to load the link with one command only */
+    void requestStat()
+    {
+      enqueueCmdMsg(raw::CMD_GETSTAT);
+    }
+};
+
+static void usage()
+{
+  cerr <<"usage: act_schilling_bin [options] <uri> <command> [args]" <<endl
+       <<"  uri: device uri, e.g. serial:///dev/ttyS0:9600, also a pty of a stand-in device" <<endl
+       <<"options:" <<endl
+       <<"  --config <file>   config file with key = value lines: velocity, ctrl_mode (none, pos, vel)," <<endl
+       <<"                    home_pos, jog_deadband, jog_watchdog, max_queue_depth, counts_per_rev," <<endl
+       <<"                    move_tolerance, trap_accel" <<endl
+       <<"  --timeout <ms>    read timeout, default 500" <<endl
+       <<"  --sim             use a simulated actuator instead of the uri" <<endl
+       <<"commands:" <<endl
+       <<"  status                    print status, position, drive status, actuator info and faults" <<endl
+       <<"  calibrate                 initialize and calibrate the actuator" <<endl
+       <<"  move <angle>              calibrate and move to angle in position mode, with the onboard" <<endl
+       <<"                            trapezoidal profile if trap_accel is set" <<endl
+       <<"  jog <velocity> <seconds>  calibrate and jog in velocity mode" <<endl
+       <<"  probe [seconds]           saturate the link with GETSTAT and report rate, round trip and errors" <<endl;
+}
+
+static bool loadConfig(string const& file, Config& config)
+{
+  ifstream in(file.c_str());
+  if(!in){
+    cerr <<"cannot open config " <<file <<endl;
+    return false;
+  }
+  string line;
+  int n = 0;
+  while(getline(in,line)){
+    n++;
+    size_t hash = line.find('#');
+    if(hash != string::npos){
+      line.erase(hash);
+    }
+    size_t eq = line.find('=');
+    if(eq == string::npos){
+      if(line.find_first_not_of(" \t\r") != string::npos){
+	cerr <<file <<":" <<n <<": expected key = value" <<endl;
+	return false;
+      }
+      continue;
+    }
+    string key, value;
+    istringstream keyStream(line.substr(0,eq));
+    istringstream valueStream(line.substr(eq+1));
+    keyStream >>key;
+    valueStream >>value;
+    if(key == "velocity"){
+      config.velocity = atoi(value.c_str());
+    }
+    else if(key == "ctrl_mode"){
+      if(value == "none"){
+	config.ctrl_mode = MODE_NONE;
+      }
+      else if(value == "pos"){
+	config.ctrl_mode = MODE_POS;
+      }
+      else if(value == "vel"){
+	config.ctrl_mode = MODE_VEL;
+      }
+      else{
+	cerr <<file <<":" <<n <<": invalid ctrl_mode " <<value <<endl;
+	return false;
+      }
+    }
+    else if(key == "home_pos"){
+      config.home_pos = atoi(value.c_str());
+    }
+    else if(key == "jog_deadband"){
+      config.jog_deadband = atof(value.c_str());
+    }
+    else if(key == "jog_watchdog"){
+      config.jog_watchdog = atoi(value.c_str());
+    }
+    else if(key == "max_queue_depth"){
+      config.max_queue_depth = atoi(value.c_str());
+    }
+    else if(key == "counts_per_rev"){
+      config.counts_per_rev = atoi(value.c_str());
+    }
+    else if(key == "move_tolerance"){
+      config.move_tolerance = atoi(value.c_str());
+    }
+    else if(key == "trap_accel"){
+      config.trap_accel = atoi(value.c_str());
+    }
+    else{
+      cerr <<file <<":" <<n <<": unknown key " <<key <<endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/** one request/reply cycle, requests the status if nothing else is queued
+ * the next command is only written when no reply is pending, otherwise that reply would be parsed as the reply to it
+ * @return false if the read failed, the pending reply is dropped then
+*/
+static bool cycle(Driver& driver)
+{
+  if(!driver.getQueueDepth()){
+    driver.requestStatus();
+  }
+  try{
+    if(driver.isIdle()){
+      driver.writeNext();
+    }
+    if(!driver.isIdle()){
+      driver.read();
+    }
+  }
+  catch(std::exception& e){
+    cerr <<"error: " <<e.what() <<endl;
+    driver.clearReadBuffer();
+    return false;
+  }
+  return true;
+}
+
+class CliBringUp : public BringUp
+{
+  protected:
+    virtual void progress(size_t axis, AxisProgress const& progress)
+    {
+      static const char* phases[] = {"idle","init","waiting","calibrating","done","failed"};
+      static const char* stages[] = {"reset","init","initialized","findmin","findmax","setzero","gohome","running"};
+      cout <<"calibrate: " <<phases[progress.phase] <<" " <<stages[progress.run_state];
+      if(!progress.error.empty()){
+	cout <<" " <<progress.error;
+      }
+      cout <<endl;
+    }
+};
+
+static bool calibrate(Driver& driver)
+{
+  CliBringUp bringUp;
+  bringUp.addAxis(&driver);
+  bool ok = bringUp.run();
+  cout <<"calibrate: " <<(ok ? "done" : "failed") <<" after " <<fixed <<setprecision(1)
+       <<bringUp.getTotalTime().toSeconds() <<"s" <<endl;
+  if(ok){
+    ActBoundaries bounds = driver.getBoundaries();
+    cout <<"boundaries: " <<bounds.min <<" .. " <<bounds.max <<endl;
+  }
+  return ok;
+}
+
+/** read only, initDevice is not called, it would clear errors and overwrite the watchdog, trapezoid and control mode settings
+*/
+static int status(Driver& driver)
+{
+  driver.clearReadBuffer();
+  driver.requestSnapshot();
+  while(driver.getQueueDepth() || !driver.isIdle()){
+    if(!cycle(driver)){
+      return 1;
+    }
+  }
+  ActSnapshot snap;
+  driver.collectSnapshot(snap);
+  cout <<"ctrl_mode: " <<snap.data.ctrl_mode <<endl
+       <<"shaft_ang: " <<snap.data.shaft_ang <<endl
+       <<"shaft_vel: " <<snap.data.shaft_vel <<endl
+       <<"shaft_pos: " <<snap.status.shaft_pos <<endl
+       <<hex <<setfill('0')
+       <<"ctrl_status: 0x" <<setw(2) <<int(snap.status.ctrl_status) <<endl
+       <<"drive_status: 0x" <<setw(2) <<int(snap.status.drive_status) <<endl
+       <<"encoder_status: 0x" <<setw(2) <<int(snap.status.encoder_status) <<endl
+       <<"drive_protect_status: 0x" <<setw(4) <<snap.drive_status.drive_protect_status <<endl
+       <<"system_protect_status: 0x" <<setw(4) <<snap.drive_status.system_protect_status <<endl
+       <<"drive_system_status1: 0x" <<setw(4) <<snap.drive_status.drive_system_status1 <<endl
+       <<"drive_system_status2: 0x" <<setw(4) <<snap.drive_status.drive_system_status2 <<endl
+       <<dec <<setfill(' ')
+       <<"ext_abs_pos: " <<snap.position.ext_abs_pos <<endl
+       <<"shaft_abs_pos: " <<snap.position.shaft_abs_pos <<endl
+       <<"serial_no: " <<snap.act_info.serial_no <<endl
+       <<"firmware_rev: " <<snap.act_info.firmware_rev <<endl;
+  HealthMonitor& health = driver.getHealthMonitor();
+  for(int f=0;f<FAULT_COUNT;f++){
+    if(health.getStats((Fault)f).active){
+      cout <<"fault: " <<HealthMonitor::getFaultName((Fault)f) <<endl;
+    }
+  }
+  return 0;
+}
+
+static int move(Driver& driver, double ang)
+{
+  driver.setControlMode(MODE_POS);
+  if(!calibrate(driver)){
+    return 1;
+  }
+  uint32_t ticket;
+  if(driver.getConfig().trap_accel){
+    driver.setTrapPos(driver.ang2count(ang),1,&ticket);
+  }
+  else{
+    driver.setAnglePos(ang,1,&ticket);
+  }
+  MoveStatus status = driver.waitMove(ticket,base::Time::fromSeconds(600));
+  static const char* states[] = {"none","active","done","stalled","superseded","aborted"};
+  cout <<"move: " <<states[status.state] <<" at " <<driver.getData().shaft_ang <<" error " <<status.error <<" counts after "
+       <<fixed <<setprecision(2) <<(status.state == MOVE_ACTIVE ? base::Time::now() : status.end).toSeconds()-status.start.toSeconds() <<"s" <<endl;
+  if(status.state != MOVE_DONE){
+    return 1;
+  }
+  return 0;
+}
+
+static int jog(Driver& driver, double vel, double seconds)
+{
+  driver.setControlMode(MODE_VEL);
+  if(!calibrate(driver)){
+    return 1;
+  }
+  driver.startJog();
+  base::Time start = base::Time::now();
+  while((base::Time::now()-start).toSeconds() < seconds){
+    driver.jog(vel);
+    if(!cycle(driver)){
+      driver.stopJog();
+      return 1;
+    }
+    if(driver.hasStatusUpdate()){
+      ActData data = driver.getData();
+      cout <<"jog: " <<data.shaft_ang <<" " <<data.shaft_vel <<endl;
+    }
+  }
+  driver.stopJog();
+  while(driver.getQueueDepth()){
+    cycle(driver);
+  }
+  return 0;
+}
+
+static int probe(CliDriver& driver, double seconds)
+{
+  driver.clearReadBuffer();
+  LatencyStats rtt;
+  unsigned long replies = 0;
+  unsigned long errors = 0;
+  base::Time start = base::Time::now();
+  base::Time now = start;
+  while((now-start).toSeconds() < seconds){
+    driver.requestStat();
+    base::Time sent = base::Time::now();
+    try{
+      driver.writeNext();
+      driver.read();
+      now = base::Time::now();
+      rtt.add(now-sent);
+      replies++;
+    }
+    catch(std::exception& e){
+      now = base::Time::now();
+      errors++;
+      driver.clearReadBuffer();
+    }
+  }
+  double elapsed = (now-start).toSeconds();
+  cout <<fixed <<setprecision(1)
+       <<"probe: " <<replies <<" replies " <<errors <<" errors in " <<elapsed <<"s" <<endl
+       <<"rate: " <<(elapsed > 0 ? replies/elapsed : 0) <<" Hz" <<endl
+       <<"round trip us: mean " <<rtt.getMean().toMicroseconds()
+       <<" p50 " <<rtt.getPercentile(50).toMicroseconds()
+       <<" p90 " <<rtt.getPercentile(90).toMicroseconds()
+       <<" p99 " <<rtt.getPercentile(99).toMicroseconds()
+       <<" max " <<rtt.getMax().toMicroseconds() <<endl;
+  return errors ? 1 : 0;
+}
 
 int main(int argc, char** argv)
 {
-	return 0;
+  Config config;
+  int timeout = 500;
+  bool sim = false;
+  int i = 1;
+  for(;i<argc && argv[i][0] == '-';i++){
+    if(!strcmp(argv[i],"--config") && i+1 < argc){
+      if(!loadConfig(argv[++i],config)){
+	return 1;
+      }
+    }
+    else if(!strcmp(argv[i],"--timeout") && i+1 < argc){
+      timeout = atoi(argv[++i]);
+    }
+    else if(!strcmp(argv[i],"--sim")){
+      sim = true;
+    }
+    else{
+      usage();
+      return 1;
+    }
+  }
+  if(argc-i < 2){
+    usage();
+    return 1;
+  }
+  string uri = argv[i];
+  string cmd = argv[i+1];
+  char** args = argv+i+2;
+  int nargs = argc-i-2;
+
+  CliDriver driver(config);
+  SimTransport simTransport;
+  try{
+    if(sim){
+      driver.setTransport(&simTransport);
+    }
+    else{
+      driver.openURI(uri);
+      driver.setReadTimeout(base::Time::fromMilliseconds(timeout));
+    }
+    if(cmd == "status"){
+      return status(driver);
+    }
+    else if(cmd == "calibrate"){
+      return calibrate(driver) ? 0 : 1;
+    }
+    else if(cmd == "move" && nargs == 1){
+      return move(driver,atof(args[0]));
+    }
+    else if(cmd == "jog" && nargs == 2){
+      return jog(driver,atof(args[0]),atof(args[1]));
+    }
+    else if(cmd == "probe" && nargs <= 1){
+      return probe(driver,nargs ? atof(args[0]) : 10);
+    }
+  }
+  catch(std::exception& e){
+    cerr <<"error: " <<e.what() <<endl;
+    return 1;
+  }
+  usage();
+  return 1;
 }
@@ -0,0 +1,156 @@
+#include "MockTransport.hpp"
+#include <base_schilling/SchillingRaw.hpp>
+#include <algorithm>
+
+using namespace act_schilling;
+using namespace act_schilling::raw;
+
+MockTransport::MockTransport()
+  : mDefaultTimeout(base::Time::fromSeconds(1)), mChunkSize(0), mCorruptEvery(0), mTruncateEvery(0),
+    mReplyCount(0), mWriteCount(0), mCorruptCount(0), mLastCmd(CMD_NONE)
+{
+}
+
+int MockTransport::readBytes(uint8_t* buffer, int buffer_size, base::Time const& timeout)
+{
+  base::Time deadline = mNow + (timeout.isNull() ? mDefaultTimeout : timeout);
+  if(mStream.empty()){
+    if(mPending.empty() || mPending.front().ready > deadline){
+      mNow = deadline;
+      return 0;
+    }
+    if(mPending.front().ready > mNow){
+      mNow = mPending.front().ready;
+    }
+  }
+  while(!mPending.empty() && !(mPending.front().ready > mNow)){
+    std::vector<uint8_t> const& bytes = mPending.front().bytes;
+    mStream.insert(mStream.end(),bytes.begin(),bytes.end());
+    mPending.pop_front();
+  }
+  size_t size = mStream.size() < (size_t)buffer_size ? mStream.size() : buffer_size;
+  if(mChunkSize && size > mChunkSize){
+    size = mChunkSize;
+  }
+  std::copy(mStream.begin(),mStream.begin()+size,buffer);
+  mStream.erase(mStream.begin(),mStream.begin()+size);
+  return size;
+}
+
+bool MockTransport::writeBytes(uint8_t const* buffer, int buffer_size)
+{
+  std::vector<uint8_t> cmd(buffer,buffer+buffer_size);
+  mWriteCount++;
+  if(buffer_size >= (int)sizeof(MsgHeader)){
+    mLastCmd = (CMD)((MsgHeader const*)buffer)->cmd;
+  }
+  PendingBytes pending;
+  pending.ready = mNow + mLatency;
+  reply(cmd,pending.bytes);
+  if(pending.bytes.empty()){
+    return true;
+  }
+  mReplyCount++;
+  if(mCorruptEvery && !(mReplyCount % mCorruptEvery)){
+    pending.bytes[mCorruptCount % pending.bytes.size()] ^= 0xFF;
+    mCorruptCount++;
+  }
+  if(mTruncateEvery && !(mReplyCount % mTruncateEvery)){
+    pending.bytes.pop_back();
+    mCorruptCount++;
+  }
+  mPending.push_back(pending);
+  return true;
+}
+
+void MockTransport::addReply(std::vector<uint8_t> const& frame)
+{
+  mScripted.push_back(frame);
+}
+
+void MockTransport::addAck()
+{
+  mScripted.push_back(std::vector<uint8_t>(1,ACT_SCHILLING_ACK));
+}
+
+void MockTransport::addNak()
+{
+  mScripted.push_back(std::vector<uint8_t>(1,ACT_SCHILLING_NAK));
+}
+
+void MockTransport::injectBytes(std::vector<uint8_t> const& bytes)
+{
+  PendingBytes pending;
+  pending.bytes = bytes;
+  pending.ready = mPending.empty() ? mNow : mPending.back().ready;
+  mPending.push_back(pending);
+}
+
+void MockTransport::setLatency(base::Time const& latency)
+{
+  mLatency = latency;
+}
+
+void MockTransport::setDefaultTimeout(base::Time const& timeout)
+{
+  mDefaultTimeout = timeout;
+}
+
+void MockTransport::setChunkSize(unsigned int bytes)
+{
+  mChunkSize = bytes;
+}
+
+void MockTransport::setCorruption(unsigned int every)
+{
+  mCorruptEvery = every;
+}
+
+void MockTransport::setTruncation(unsigned int every)
+{
+  mTruncateEvery = every;
+}
+
+base::Time MockTransport::getTime() const
+{
+  return mNow;
+}
+
+size_t MockTransport::getWriteCount() const
+{
+  return mWriteCount;
+}
+
+CMD MockTransport::getLastCmd() const
+{
+  return mLastCmd;
+}
+
+size_t MockTransport::getCorruptCount() const
+{
+  return mCorruptCount;
+}
+
+std::vector<uint8_t> MockTransport::makeReply(std::vector<uint8_t> const& payload)
+{
+  std::vector<uint8_t> frame(payload.size()+3);
+  frame[0] = SCHILL_REPL_UNCHG_MSG;
+  frame[1] = frame.size();
+  uint8_t cs = frame[0] + frame[1];
+  for(size_t i=0;i<payload.size();i++){
+    frame[i+2] = payload[i];
+    cs += payload[i];
+  }
+  frame[frame.size()-1] = 0x100 - cs;
+  return frame;
+}
+
+void MockTransport::reply(std::vector<uint8_t> const& cmd, std::vector<uint8_t>& frame)
+{
+  if(mScripted.empty()){
+    frame.assign(1,ACT_SCHILLING_ACK);
+    return;
+  }
+  frame = mScripted.front();
+  mScripted.pop_front();
+}
@@ -0,0 +1,98 @@
+#ifndef _ACT_SCHILLING_MOCKTRANSPORT_HPP_
+#define _ACT_SCHILLING_MOCKTRANSPORT_HPP_
+
+#include <deque>
+#include <vector>
+#include "Transport.hpp"
+#include "ActRaw.hpp"
+
+namespace act_schilling
+{
+
+  /** In-memory byte stream with scripted replies, injected latency and byte level faults
+   * each written command produces one reply, taken from the scripted replies or an ACK if none is left,
+   * time is simulated, so latency and timeouts are deterministic and never sleep
+  */
+  class MockTransport : public Transport
+  {
+    struct PendingBytes{
+      std::vector<uint8_t> bytes;
+      base::Time ready;
+    };
+  
+    public:
+      MockTransport();
+      virtual ~MockTransport() {}
+      virtual int readBytes(uint8_t* buffer, int buffer_size, base::Time const& timeout = base::Time());
+      virtual bool writeBytes(uint8_t const* buffer, int buffer_size);
+      /** queue a scripted reply frame, replies are consumed in order, one per written command
+      */
+      void addReply(std::vector<uint8_t> const& frame);
+      /** queue a scripted ACK
+      */
+      void addAck();
+      /** queue a scripted NAK
+      */
+      void addNak();
+      /** queue bytes into the stream, they arrive after the replies already pending, e.g. to inject line noise
+      */
+      void injectBytes(std::vector<uint8_t> const& bytes);
+      /** set the simulated time between a command and its reply, replies later than the read timeout cause timeouts
+      */
+      void setLatency(base::Time const& latency);
+      /** set the timeout used by readBytes if none is given, 1s by default
+      */
+      void setDefaultTimeout(base::Time const& timeout);
+      /** set the max number of bytes returned by one readBytes call, to split packets over several reads
+       * @arg bytes: max bytes per read, 0 for no limit
+      */
+      void setChunkSize(unsigned int bytes);
+      /** corrupt one byte of every n-th reply, the corrupted byte rotates through the frame including its header
+       * @arg every: corrupt every n-th reply, 0 disables corruption
+      */
+      void setCorruption(unsigned int every);
+      /** drop the last byte of every n-th reply
+       * @arg every: truncate every n-th reply, 0 disables truncation
+      */
+      void setTruncation(unsigned int every);
+      /** @return simulated time, advanced by latency and expired timeouts
+      */
+      base::Time getTime() const;
+      /** @return number of commands written
+      */
+      size_t getWriteCount() const;
+      /** @return last command written, CMD_NONE if none
+      */
+      raw::CMD getLastCmd() const;
+      /** @return number of replies corrupted or truncated
+      */
+      size_t getCorruptCount() const;
+      /** build a reply frame with header and checksum around the payload
+       * @arg payload: reply bytes following the header
+      */
+      static std::vector<uint8_t> makeReply(std::vector<uint8_t> const& payload);
+    protected:
+      /** produce the reply to a command, override this to emulate a device
+       * the default takes the next scripted reply or an ACK
+       * @arg cmd: command frame written by the driver
+       * @arg frame: reply frame, leave empty to send no reply
+      */
+      virtual void reply(std::vector<uint8_t> const& cmd, std::vector<uint8_t>& frame);
+      std::deque<std::vector<uint8_t> > mScripted;
+    private:
+      std::deque<PendingBytes> mPending;
+      std::deque<uint8_t> mStream;
+      base::Time mNow;
+      base::Time mLatency;
+      base::Time mDefaultTimeout;
+      unsigned int mChunkSize;
+      unsigned int mCorruptEvery;
+      unsigned int mTruncateEvery;
+      size_t mReplyCount;
+      size_t mWriteCount;
+      size_t mCorruptCount;
+      raw::CMD mLastCmd;
+  };
+}
+
+#endif
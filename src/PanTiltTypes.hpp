@@ -23,6 +23,10 @@ namespace act_schilling {
     JoyStickMapping() :
       time(base::Time::now()), configureButton(0), inputAxisNumber(0), inputAxisDimension(0), inputAxisInvert(true)
     {}
+    //! construct with a given timestamp, avoids reading the clock
+    explicit JoyStickMapping(base::Time const& t) :
+      time(t), configureButton(0), inputAxisNumber(0), inputAxisDimension(0), inputAxisInvert(true)
+    {}
   };
 
   /** This structure holds PanTiltDefaultPos data */
@@ -37,6 +41,10 @@ namespace act_schilling {
     PanTiltDefaultPos(std::vector<int> i_pos_value) :
       time(base::Time::now()), pos_value(i_pos_value)
     {}
+    //! construct with a given timestamp, avoids reading the clock
+    explicit PanTiltDefaultPos(base::Time const& t, std::vector<int> i_pos_value = std::vector<int>()) :
+      time(t), pos_value(i_pos_value)
+    {}
   };
 }
 
@@ -0,0 +1,136 @@
+#include "PresetEngine.hpp"
+#include <stdlib.h>
+#include <stdexcept>
+
+using namespace act_schilling;
+
+PresetEngine::PresetEngine(double counts_per_vel)
+  : mCountsPerVel(counts_per_vel), mCompiled(false)
+{
+  if(!(counts_per_vel > 0)){
+    throw std::runtime_error("PresetEngine: counts_per_vel has to be positive");
+  }
+}
+
+void PresetEngine::addAxis(ActHandler* axis)
+{
+  mAxes.push_back(axis);
+  mCompiled = false;
+}
+
+void PresetEngine::setPresets(std::vector<PanTiltDefaultPos> const& presets)
+{
+  mPresets = presets;
+  mCompiled = false;
+}
+
+bool PresetEngine::compile()
+{
+  for(size_t i=0;i<mAxes.size();i++){
+    if(!mAxes[i]->getState().calibrated){
+      return false;
+    }
+  }
+  mBoundaries.resize(mAxes.size());
+  for(size_t i=0;i<mAxes.size();i++){
+    mBoundaries[i] = mAxes[i]->getBoundaries();
+  }
+  mPresetCounts.resize(mPresets.size());
+  for(size_t p=0;p<mPresets.size();p++){
+    std::vector<int> const& ang = mPresets[p].pos_value;
+    size_t n = ang.size() < mAxes.size() ? ang.size() : mAxes.size();
+    mPresetCounts[p].resize(n);
+    for(size_t i=0;i<n;i++){
+      ActBoundaries const& bounds = mBoundaries[i];
+      double a = ang[i];
+      if(a<bounds.min){
+	a = bounds.min;
+      }
+      if(a>bounds.max){
+	a = bounds.max;
+      }
+      mPresetCounts[p][i] = mAxes[i]->ang2count(a);
+    }
+  }
+  mCompiled = true;
+  return true;
+}
+
+bool PresetEngine::isCompiled() const
+{
+  return mCompiled;
+}
+
+size_t PresetEngine::getPresetCount() const
+{
+  return mPresets.size();
+}
+
+std::vector<int> const& PresetEngine::getPresetCounts(size_t preset) const
+{
+  return mPresetCounts.at(preset);
+}
+
+int PresetEngine::getPresetForButton(JoyStickMapping const& mapping, int button) const
+{
+  for(size_t i=0;i<mapping.defaultValButtons.size() && i<mPresets.size();i++){
+    if(mapping.defaultValButtons[i] == button){
+      return i;
+    }
+  }
+  return -1;
+}
+
+base::Time PresetEngine::goToPreset(size_t preset)
+{
+  if(preset >= mPresets.size()){
+    return base::Time();
+  }
+  //a recalibration may have changed the boundaries the presets are clamped to
+  for(size_t i=0;mCompiled && i<mAxes.size();i++){
+    ActBoundaries bounds = mAxes[i]->getBoundaries();
+    if(!mAxes[i]->getState().calibrated || bounds.min != mBoundaries[i].min || bounds.max != mBoundaries[i].max){
+      mCompiled = false;
+    }
+  }
+  if(!mCompiled && !compile()){
+    return base::Time();
+  }
+  std::vector<int> const& counts = mPresetCounts[preset];
+  for(size_t i=0;i<counts.size();i++){
+    if(mAxes[i]->getConfig().ctrl_mode != MODE_POS){
+      return base::Time();
+    }
+  }
+  //travel time of each axis at its configured velocity, the slowest one determines the arrival
+  std::vector<double> duration(counts.size());
+  double maxDuration = 0;
+  for(size_t i=0;i<counts.size();i++){
+    int dist = abs(counts[i] - mAxes[i]->getDeviceStatus().shaft_pos);
+    double vel = mAxes[i]->getConfig().velocity * mCountsPerVel;
+    if(dist && vel <= 0){
+      //the axis would never arrive
+      return base::Time();
+    }
+    duration[i] = dist ? dist/vel : 0;
+    if(duration[i] > maxDuration){
+      maxDuration = duration[i];
+    }
+  }
+  base::Time now = base::Time::now();
+  if(maxDuration <= 0){
+    return now;
+  }
+  //dispatch to all axes or none, a preset reached by only some axes is worse than a skipped one
+  for(size_t i=0;i<counts.size();i++){
+    if(duration[i] > 0 && !mAxes[i]->hasQueueCapacity(ActHandler::POS_MSGS)){
+      return base::Time();
+    }
+  }
+  for(size_t i=0;i<counts.size();i++){
+    if(duration[i] > 0){
+      mAxes[i]->setPos(counts[i],duration[i]/maxDuration);
+    }
+  }
+  return now + base::Time::fromSeconds(maxDuration);
+}
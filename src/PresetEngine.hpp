@@ -0,0 +1,66 @@
+#ifndef _ACT_SCHILLING_PRESETENGINE_HPP_
+#define _ACT_SCHILLING_PRESETENGINE_HPP_
+
+#include <vector>
+#include "ActHandler.hpp"
+#include "PanTiltTypes.hpp"
+
+namespace act_schilling
+{
+
+  class PresetEngine
+  {
+    public:
+      /** @arg counts_per_vel: encoder counts per second the actuators move per unit of velocity of Config::velocity,
+       * depends on the drive and has to be measured, e.g. from shaft_pos over time at a known velocity
+       * throws std::runtime_error if counts_per_vel is not positive
+      */
+      explicit PresetEngine(double counts_per_vel);
+      /** add an actuator, the order of the axes corresponds to the order of the pos_value entries of the presets
+       * @arg axis: actuator handler, has to outlive the engine
+      */
+      void addAxis(ActHandler* axis);
+      /** set the presets, pos_value holds one angle per axis
+       * axes without a value in pos_value are not moved by the preset
+      */
+      void setPresets(std::vector<PanTiltDefaultPos> const& presets);
+      /** convert the presets to encoder counts clamped to the boundaries of the axes
+       * call this after all axes are calibrated, goToPreset calls it if not done yet or if the boundaries of an axis changed
+       * @return true if all axes are calibrated and the presets have been converted
+      */
+      bool compile();
+      /** @return true if the presets have been converted to encoder counts
+      */
+      bool isCompiled() const;
+      /** @return number of presets
+      */
+      size_t getPresetCount() const;
+      /** get the encoder counts of a preset, only valid if compiled
+       * @arg preset: preset index
+      */
+      std::vector<int> const& getPresetCounts(size_t preset) const;
+      /** find the preset assigned to a joystick button by defaultValButtons
+       * @arg mapping: joystick mapping
+       * @arg button: button number
+       * @return preset index or -1 if no preset is assigned to the button
+      */
+      int getPresetForButton(JoyStickMapping const& mapping, int button) const;
+      /** move all axes to a preset, velocities are chosen so that all axes arrive at the same time
+       * only comes into effect if all axes are calibrated and in position mode
+       * @arg preset: preset index
+       * the preset is not dispatched to any axis if the message queue of one of them is full or an axis which has to move has no velocity
+       * @return expected arrival time, null if the preset has not been dispatched
+      */
+      base::Time goToPreset(size_t preset);
+    private:
+      double mCountsPerVel;
+      std::vector<ActHandler*> mAxes;
+      std::vector<PanTiltDefaultPos> mPresets;
+      std::vector<std::vector<int> > mPresetCounts;
+      //! boundaries of the axes the presets have been converted with
+      std::vector<ActBoundaries> mBoundaries;
+      bool mCompiled;
+  };
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include "SimTransport.hpp"
+#include <math.h>
+
+using namespace act_schilling;
+using namespace act_schilling::raw;
+
+static int cmdValue(std::vector<uint8_t> const& cmd)
+{
+  //value bytes between header and checksum, big endian
+  int value = 0;
+  size_t length = cmd.size() > 4 ? cmd.size()-4 : 0;
+  for(size_t i=0;i<length;i++){
+    value = (value << 8) | cmd[3+i];
+  }
+  if(length && length < 4 && (cmd[3] & 0x80)){
+    value -= 1 << (8*length);
+  }
+  return value;
+}
+
+static void putBE(std::vector<uint8_t>& payload, int value, int length)
+{
+  for(int i=length-1;i>=0;i--){
+    payload.push_back((value >> (8*i)) & 0xFF);
+  }
+}
+
+SimTransport::SimTransport(int min_count, int max_count)
+  : mMin(min_count), mMax(max_count), mPos(0), mTarget(0), mVel(0), mStep(1),
+    mCtrlMode(MODE_NONE), mCtrlStatus(0), mDriveStatus(0), mEncoderStatus(0)
+{
+}
+
+void SimTransport::setStep(double counts_per_vel)
+{
+  mStep = counts_per_vel;
+}
+
+void SimTransport::setStatusBytes(uint8_t ctrl_status, uint8_t drive_status, uint8_t encoder_status)
+{
+  mCtrlStatus = ctrl_status;
+  mDriveStatus = drive_status;
+  mEncoderStatus = encoder_status;
+}
+
+int SimTransport::getShaftPos() const
+{
+  return mPos;
+}
+
+void SimTransport::reply(std::vector<uint8_t> const& cmd, std::vector<uint8_t>& frame)
+{
+  if(!mScripted.empty()){
+    MockTransport::reply(cmd,frame);
+    return;
+  }
+  if(cmd.size() < 4){
+    frame.assign(1,ACT_SCHILLING_NAK);
+    return;
+  }
+  std::vector<uint8_t> payload;
+  switch(((MsgHeader const*)cmd.data())->cmd){
+    case CMD_SETSHAFTPOS:
+    case CMD_SETTRAPPOS:
+      mTarget = cmdValue(cmd);
+      break;
+    case CMD_SETVEL:
+      mVel = double(cmdValue(cmd))/ACT_VEL_COEFF;
+      break;
+    case CMD_SETCTRLMODE:
+      mCtrlMode = (ControlMode)cmdValue(cmd);
+      break;
+    case CMD_CLRSHAFTPOS:
+      mMin -= mPos;
+      mMax -= mPos;
+      mTarget -= mPos;
+      mPos = 0;
+      break;
+    case CMD_GETSTAT:{
+      step();
+      payload.push_back(mCtrlStatus);
+      payload.push_back(mDriveStatus);
+      payload.push_back(mCtrlMode);
+      putBE(payload,mPos,4);
+      int vel = mCtrlMode == MODE_NONE || (mCtrlMode == MODE_POS && mPos == mTarget) ? 0 : mVel*ACT_VEL_COEFF;
+      putBE(payload,vel,2);
+      break;
+    }
+    case CMD_GETPOS:
+      payload.push_back(0);
+      putBE(payload,0,2);
+      putBE(payload,mPos,4);
+      payload.push_back(mEncoderStatus);
+      putBE(payload,mPos & 0xFFFF,2);
+      break;
+    case CMD_GETDRVSTAT:
+      payload.push_back(mDriveStatus);
+      putBE(payload,0,2);
+      putBE(payload,0,2);
+      putBE(payload,0,2);
+      putBE(payload,0,2);
+      break;
+    case CMD_GETACTINFO:
+      putBE(payload,0,4);
+      putBE(payload,1,2);
+      payload.push_back(1);
+      putBE(payload,0,2);
+      break;
+    default:
+      break;
+  }
+  if(payload.empty()){
+    frame.assign(1,ACT_SCHILLING_ACK);
+  }
+  else{
+    frame = makeReply(payload);
+  }
+}
+
+void SimTransport::step()
+{
+  double delta = fabs(mVel)*mStep;
+  if(mCtrlMode == MODE_POS){
+    int dist = mTarget - mPos;
+    if(fabs(double(dist)) <= delta){
+      mPos = mTarget;
+    }
+    else{
+      mPos += dist > 0 ? int(delta) : -int(delta);
+    }
+  }
+  else if(mCtrlMode == MODE_VEL){
+    mPos += int(mVel*mStep);
+  }
+  if(mPos < mMin){
+    mPos = mMin;
+  }
+  if(mPos > mMax){
+    mPos = mMax;
+  }
+}
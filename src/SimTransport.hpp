@@ -0,0 +1,49 @@
+#ifndef _ACT_SCHILLING_SIMTRANSPORT_HPP_
+#define _ACT_SCHILLING_SIMTRANSPORT_HPP_
+
+#include "MockTransport.hpp"
+#include "ActTypes.hpp"
+
+namespace act_schilling
+{
+
+  /** Simulated actuator on top of MockTransport
+   * replies to the status commands with the simulated state and moves the shaft by one step per GETSTAT,
+   * the shaft stops at the mechanical end stops, so a full calibration can be run against it
+  */
+  class SimTransport : public MockTransport
+  {
+    public:
+      /** @arg min_count: mechanical end stop in encoder counts
+       * @arg max_count: mechanical end stop in encoder counts
+      */
+      SimTransport(int min_count = -ACT_FULLPOS/4, int max_count = ACT_FULLPOS/4);
+      virtual ~SimTransport() {}
+      /** set the motion per GETSTAT
+       * @arg counts_per_vel: encoder counts the shaft moves per unit of velocity on each GETSTAT
+      */
+      void setStep(double counts_per_vel);
+      /** set the status bytes reported by GETSTAT and GETPOS, e.g. to inject faults
+      */
+      void setStatusBytes(uint8_t ctrl_status, uint8_t drive_status, uint8_t encoder_status);
+      /** @return simulated shaft position in encoder counts
+      */
+      int getShaftPos() const;
+    protected:
+      virtual void reply(std::vector<uint8_t> const& cmd, std::vector<uint8_t>& frame);
+    private:
+      void step();
+      int mMin;
+      int mMax;
+      int mPos;
+      int mTarget;
+      double mVel;
+      double mStep;
+      ControlMode mCtrlMode;
+      uint8_t mCtrlStatus;
+      uint8_t mDriveStatus;
+      uint8_t mEncoderStatus;
+  };
+}
+
+#endif
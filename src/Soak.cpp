@@ -0,0 +1,228 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <new>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "Driver.hpp"
+#include "SimTransport.hpp"
+#include "LatencyStats.hpp"
+
+using namespace act_schilling;
+using namespace std;
+
+static size_t gAllocs = 0;
+static size_t gFrees = 0;
+
+void* operator new(size_t size)
+{
+  gAllocs++;
+  void* p = malloc(size ? size : 1);
+  if(!p){
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p)
+{
+  if(p){
+    gFrees++;
+    free(p);
+  }
+}
+
+struct Window{
+  double elapsed;
+  long rss_kb;
+  long live_allocs;
+  size_t max_queue;
+  double p50_us;
+  double p99_us;
+};
+
+/** enqueue times of the commands in the driver queue, in queue order, fixed size so it does not allocate while running
+*/
+class SentTimes
+{
+  public:
+    SentTimes() : mHead(0), mSize(0) {}
+    /** record count commands enqueued at time, drops the oldest times if full
+    */
+    void push(base::Time const& time, size_t count)
+    {
+      for(size_t i=0;i<count;i++){
+        if(mSize == SIZE){
+          pop();
+        }
+        mTimes[(mHead+mSize)%SIZE] = time;
+        mSize++;
+      }
+    }
+    /** @return enqueue time of the oldest command, null if none is recorded
+    */
+    base::Time pop()
+    {
+      if(!mSize){
+        return base::Time();
+      }
+      base::Time time = mTimes[mHead];
+      mHead = (mHead+1)%SIZE;
+      mSize--;
+      return time;
+    }
+  private:
+    static const size_t SIZE = 1024;
+    base::Time mTimes[SIZE];
+    size_t mHead;
+    size_t mSize;
+};
+
+static long rssKb()
+{
+  long pages = 0;
+  FILE* f = fopen("/proc/self/statm","r");
+  if(f){
+    if(fscanf(f,"%*d %ld",&pages) != 1){
+      pages = 0;
+    }
+    fclose(f);
+  }
+  return pages*(sysconf(_SC_PAGESIZE)/1024);
+}
+
+static void usage()
+{
+  cerr <<"usage: act_schilling_soak [duration_s] [window_s] [drain_per_cycle]" <<endl
+       <<"  runs the driver against a simulated actuator and fails if memory, allocations," <<endl
+       <<"  queue depth or latency drift between the first and the last window, or if the queue limit turns commands away" <<endl;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc > 1 && argv[1][0] == '-'){
+    usage();
+    return 1;
+  }
+  double duration = argc > 1 ? atof(argv[1]) : 60;
+  double windowLength = argc > 2 ? atof(argv[2]) : 5;
+  int drain = argc > 3 ? atoi(argv[3]) : 3;
+  if(duration <= 0 || windowLength <= 0 || drain <= 0){
+    usage();
+    return 1;
+  }
+
+  SimTransport sim;
+  Config config;
+  config.ctrl_mode = MODE_POS;
+  Driver driver(config);
+  driver.setTransport(&sim);
+  LatencyStats latency;
+  vector<Window> windows;
+
+  driver.initDevice();
+  driver.calibrate();
+  base::Time start = base::Time::now();
+  base::Time windowStart = start;
+  size_t maxQueue = 0;
+  unsigned long cycles = 0;
+  unsigned long errors = 0;
+  unsigned long rejected = 0;
+  unsigned long dropped = 0;
+  SentTimes sent;
+  sent.push(start,driver.getQueueDepth());
+  while((base::Time::now()-start).toSeconds() < duration){
+    //producer: status every cycle, a new setpoint every 10th cycle
+    size_t depth = driver.getQueueDepth();
+    if(driver.requestStatus() == QUEUE_REJECTED){
+      dropped++;
+    }
+    if(driver.getState().calibrated && !(cycles % 10)){
+      if(driver.setAnglePos((cycles/10 % 2) ? 20 : -20) == QUEUE_REJECTED){
+	rejected++;
+      }
+    }
+    //latency is measured from enqueueing a command to its reply, so queueing delay is included
+    sent.push(base::Time::now(),driver.getQueueDepth()-depth);
+    if(driver.getQueueDepth() > maxQueue){
+      maxQueue = driver.getQueueDepth();
+    }
+    //link: drains a fixed number of messages per cycle
+    for(int i=0;i<drain && driver.getQueueDepth();i++){
+      base::Time enqueued = sent.pop();
+      driver.writeNext();
+      try{
+	driver.read();
+	latency.add(base::Time::now()-enqueued);
+      }
+      catch(std::exception& e){
+	errors++;
+      }
+    }
+    driver.hasStatusUpdate();
+    cycles++;
+
+    base::Time now = base::Time::now();
+    //the last window of the run is kept only if it covers at least half a window, shorter ones have too few samples to compare
+    bool end = (now-start).toSeconds() >= duration && (now-windowStart).toSeconds() >= windowLength/2;
+    if(end || (now-windowStart).toSeconds() >= windowLength){
+      Window w;
+      w.elapsed = (now-start).toSeconds();
+      w.rss_kb = rssKb();
+      w.live_allocs = long(gAllocs)-long(gFrees);
+      w.max_queue = maxQueue;
+      w.p50_us = latency.getPercentile(50).toMicroseconds();
+      w.p99_us = latency.getPercentile(99).toMicroseconds();
+      windows.push_back(w);
+      cout <<fixed <<setprecision(1) <<w.elapsed <<"s cycles " <<cycles <<" rss " <<w.rss_kb <<"kB live allocs " <<w.live_allocs
+	   <<" max queue " <<w.max_queue <<" p50 " <<w.p50_us <<"us p99 " <<w.p99_us <<"us errors " <<errors <<" rejected " <<rejected <<" dropped " <<dropped <<endl;
+      latency.reset();
+      maxQueue = 0;
+      windowStart = now;
+    }
+  }
+
+  if(!driver.getState().calibrated){
+    cerr <<"FAIL: actuator has not been calibrated" <<endl;
+    return 1;
+  }
+  if(windows.size() < 3){
+    cerr <<"FAIL: run too short, need at least 3 windows" <<endl;
+    return 1;
+  }
+  //the first window contains calibration and warm up, compare against the second one
+  Window const& first = windows[1];
+  Window const& last = windows.back();
+  bool failed = false;
+  if(last.rss_kb > first.rss_kb + 1024){
+    cerr <<"FAIL: rss grew from " <<first.rss_kb <<"kB to " <<last.rss_kb <<"kB" <<endl;
+    failed = true;
+  }
+  if(last.live_allocs > first.live_allocs + 64){
+    cerr <<"FAIL: live allocations grew from " <<first.live_allocs <<" to " <<last.live_allocs <<endl;
+    failed = true;
+  }
+  if(last.max_queue > first.max_queue + 4){
+    cerr <<"FAIL: queue depth grew from " <<first.max_queue <<" to " <<last.max_queue <<endl;
+    failed = true;
+  }
+  if(last.p99_us > 2*first.p99_us + 10){
+    cerr <<"FAIL: p99 latency grew from " <<first.p99_us <<"us to " <<last.p99_us <<"us" <<endl;
+    failed = true;
+  }
+  if(errors){
+    cerr <<"FAIL: " <<errors <<" read errors" <<endl;
+    failed = true;
+  }
+  //the queue limit hides a producer outrunning the link, so any command turned away by it is a failure
+  if(rejected || dropped){
+    cerr <<"FAIL: queue full, " <<rejected <<" setpoints rejected and " <<dropped <<" status requests dropped" <<endl;
+    failed = true;
+  }
+  if(failed){
+    return 1;
+  }
+  cout <<"PASS: " <<cycles <<" cycles in " <<last.elapsed <<"s" <<endl;
+  return 0;
+}
@@ -0,0 +1,268 @@
+#include "TelemetryPublisher.hpp"
+#include <stdexcept>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TELEMETRY_MAGIC 0x41435453
+#define TELEMETRY_VERSION 2
+//reads of a slot the writer is updating are retried this often before giving up
+#define TELEMETRY_READ_RETRIES 64
+
+namespace act_schilling {
+  namespace shm {
+    //seqlock per slot: odd while the writer updates it, 2*n when it holds sample n
+    //seq, head and closed are only accessed with atomic builtins, release by the writer and acquire by the readers
+    struct Slot{
+      uint64_t seq;
+      TelemetrySample sample;
+    };
+
+    struct Ring{
+      uint32_t magic;
+      uint32_t version;
+      uint32_t capacity;
+      uint32_t sample_size;
+      //set when the publisher is destroyed or replaced, the ring gets no new samples then
+      uint32_t closed;
+      uint64_t head;
+      Slot slots[1];
+    };
+  }
+}
+
+using namespace act_schilling;
+using namespace act_schilling::shm;
+
+enum SlotRead{
+  SLOT_OK,
+  //the sample is being written or has not been written yet, a retry may succeed
+  SLOT_BUSY,
+  //the slot holds or is being updated with a newer sample
+  SLOT_OVERWRITTEN
+};
+
+static SlotRead readSlot(Ring const* ring, uint64_t seq, TelemetrySample& sample)
+{
+  Slot const& slot = ring->slots[seq % ring->capacity];
+  uint64_t before = __atomic_load_n(&slot.seq,__ATOMIC_ACQUIRE);
+  if(before != 2*seq){
+    return before > 2*seq ? SLOT_OVERWRITTEN : SLOT_BUSY;
+  }
+  memcpy(&sample,&slot.sample,sizeof(sample));
+  //keep the copy before the second check of the sequence
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  uint64_t after = __atomic_load_n(&slot.seq,__ATOMIC_RELAXED);
+  if(after != before){
+    return SLOT_OVERWRITTEN;
+  }
+  return SLOT_OK;
+}
+
+static size_t ringSize(uint32_t capacity)
+{
+  return sizeof(Ring) + (capacity-1)*sizeof(Slot);
+}
+
+//close the ring of a previous publisher, also if it died without destructor, its readers would wait for samples forever
+static void closeRing(std::string const& name)
+{
+  int fd = shm_open(name.c_str(),O_RDWR,0);
+  if(fd < 0){
+    return;
+  }
+  struct stat st;
+  if(fstat(fd,&st) == 0 && st.st_size >= (off_t)sizeof(Ring)){
+    void* p = mmap(0,st.st_size,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+    if(p != MAP_FAILED){
+      Ring* ring = (Ring*)p;
+      if(__atomic_load_n(&ring->magic,__ATOMIC_ACQUIRE) == TELEMETRY_MAGIC && ring->version == TELEMETRY_VERSION){
+	__atomic_store_n(&ring->closed,1,__ATOMIC_RELEASE);
+      }
+      munmap(p,st.st_size);
+    }
+  }
+  ::close(fd);
+}
+
+static std::runtime_error sysError(std::string const& what, std::string const& name)
+{
+  return std::runtime_error(what + " " + name + ": " + strerror(errno));
+}
+
+TelemetryPublisher::TelemetryPublisher(std::string const& name, uint32_t capacity)
+  : mName(name), mRing(0), mSize(ringSize(capacity ? capacity : 1)), mKeep(false)
+{
+  if(!capacity){
+    capacity = 1;
+  }
+  closeRing(name);
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(),O_CREAT|O_EXCL|O_RDWR,0644);
+  if(fd < 0){
+    throw sysError("cannot create shared memory",name);
+  }
+  if(ftruncate(fd,mSize) < 0){
+    ::close(fd);
+    shm_unlink(name.c_str());
+    throw sysError("cannot size shared memory",name);
+  }
+  void* p = mmap(0,mSize,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+  ::close(fd);
+  if(p == MAP_FAILED){
+    shm_unlink(name.c_str());
+    throw sysError("cannot map shared memory",name);
+  }
+  mRing = (Ring*)p;
+  mRing->capacity = capacity;
+  mRing->sample_size = sizeof(TelemetrySample);
+  mRing->version = TELEMETRY_VERSION;
+  mRing->closed = 0;
+  mRing->head = 0;
+  //magic last, readers opening before this reject the ring
+  __atomic_store_n(&mRing->magic,TELEMETRY_MAGIC,__ATOMIC_RELEASE);
+}
+
+TelemetryPublisher::~TelemetryPublisher()
+{
+  __atomic_store_n(&mRing->closed,1,__ATOMIC_RELEASE);
+  munmap(mRing,mSize);
+  if(!mKeep){
+    shm_unlink(mName.c_str());
+  }
+}
+
+void TelemetryPublisher::publish(ActData const& data, ActDeviceStatus const& status)
+{
+  TelemetrySample sample;
+  sample.time_us = data.time.toMicroseconds();
+  sample.ctrl_mode = data.ctrl_mode;
+  sample.shaft_pos = status.shaft_pos;
+  sample.shaft_ang = data.shaft_ang;
+  sample.shaft_vel = data.shaft_vel;
+  sample.ctrl_status = status.ctrl_status;
+  sample.drive_status = status.drive_status;
+  sample.encoder_status = status.encoder_status;
+  publish(sample);
+}
+
+void TelemetryPublisher::publish(TelemetrySample const& sample)
+{
+  uint64_t seq = mRing->head + 1;
+  Slot& slot = mRing->slots[seq % mRing->capacity];
+  __atomic_store_n(&slot.seq,2*seq - 1,__ATOMIC_RELAXED);
+  //keep the odd sequence before the sample update
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(&slot.sample,&sample,sizeof(sample));
+  __atomic_store_n(&slot.seq,2*seq,__ATOMIC_RELEASE);
+  __atomic_store_n(&mRing->head,seq,__ATOMIC_RELEASE);
+}
+
+uint64_t TelemetryPublisher::getSequence() const
+{
+  return __atomic_load_n(&mRing->head,__ATOMIC_ACQUIRE);
+}
+
+void TelemetryPublisher::setKeep(bool keep)
+{
+  mKeep = keep;
+}
+
+TelemetryReader::TelemetryReader(std::string const& name)
+  : mRing(0), mSize(0), mNext(1)
+{
+  int fd = shm_open(name.c_str(),O_RDONLY,0);
+  if(fd < 0){
+    throw sysError("cannot open shared memory",name);
+  }
+  struct stat st;
+  if(fstat(fd,&st) < 0 || st.st_size < (off_t)sizeof(Ring)){
+    ::close(fd);
+    throw std::runtime_error("invalid telemetry shared memory " + name);
+  }
+  mSize = st.st_size;
+  void* p = mmap(0,mSize,PROT_READ,MAP_SHARED,fd,0);
+  ::close(fd);
+  if(p == MAP_FAILED){
+    throw sysError("cannot map shared memory",name);
+  }
+  mRing = (Ring const*)p;
+  if(__atomic_load_n(&mRing->magic,__ATOMIC_ACQUIRE) != TELEMETRY_MAGIC || mRing->version != TELEMETRY_VERSION ||
+    mRing->sample_size != sizeof(TelemetrySample) || ringSize(mRing->capacity) > mSize){
+    munmap(p,mSize);
+    throw std::runtime_error("invalid telemetry shared memory " + name);
+  }
+}
+
+TelemetryReader::~TelemetryReader()
+{
+  munmap((void*)mRing,mSize);
+}
+
+uint64_t TelemetryReader::getSequence() const
+{
+  return __atomic_load_n(&mRing->head,__ATOMIC_ACQUIRE);
+}
+
+bool TelemetryReader::isClosed() const
+{
+  return __atomic_load_n(&mRing->closed,__ATOMIC_ACQUIRE) != 0;
+}
+
+bool TelemetryReader::read(uint64_t seq, TelemetrySample& sample) const
+{
+  if(!seq){
+    return false;
+  }
+  return readSlot(mRing,seq,sample) == SLOT_OK;
+}
+
+bool TelemetryReader::readLatest(TelemetrySample& sample, uint64_t* seq) const
+{
+  //bounded, a writer which died in the middle of an update leaves the slot odd forever
+  for(int i=0;i<TELEMETRY_READ_RETRIES;i++){
+    uint64_t head = getSequence();
+    if(!head){
+      return false;
+    }
+    if(readSlot(mRing,head,sample) == SLOT_OK){
+      if(seq){
+	*seq = head;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TelemetryReader::readNext(TelemetrySample& sample, uint64_t* seq)
+{
+  for(int i=0;i<TELEMETRY_READ_RETRIES;i++){
+    uint64_t head = getSequence();
+    if(mNext > head){
+      return false;
+    }
+    //skip samples which have been overwritten already
+    if(head - mNext >= mRing->capacity){
+      mNext = head - mRing->capacity + 1;
+    }
+    switch(readSlot(mRing,mNext,sample)){
+      case SLOT_OK:
+	if(seq){
+	  *seq = mNext;
+	}
+	mNext++;
+	return true;
+      case SLOT_OVERWRITTEN:
+	mNext++;
+	break;
+      case SLOT_BUSY:
+	//retry the same sample, it is only skipped once it has been overwritten
+	break;
+    }
+  }
+  return false;
+}
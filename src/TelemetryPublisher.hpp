@@ -0,0 +1,114 @@
+#ifndef _ACT_SCHILLING_TELEMETRYPUBLISHER_HPP_
+#define _ACT_SCHILLING_TELEMETRYPUBLISHER_HPP_
+
+#include <string>
+#include <stdint.h>
+#include "ActTypes.hpp"
+
+namespace act_schilling
+{
+
+  /** This structure holds one published telemetry sample, plain data so it can live in shared memory */
+  struct TelemetrySample{
+    //! timestamp in microseconds
+    int64_t time_us;
+    //! control mode
+    int32_t ctrl_mode;
+    //! shaft position in signed encoder counts
+    int32_t shaft_pos;
+    //! actual position in signed angle
+    double shaft_ang;
+    //! actual shaft velocity
+    double shaft_vel;
+    //! control status
+    uint8_t ctrl_status;
+    //! drive status
+    uint8_t drive_status;
+    //! encoder status
+    uint8_t encoder_status;
+  };
+
+  namespace shm {
+    struct Slot;
+    struct Ring;
+  }
+
+  /** Publishes telemetry into a lock-free ring in POSIX shared memory
+   * there is one writer, readers in other processes use TelemetryReader and never block the writer
+  */
+  class TelemetryPublisher
+  {
+    public:
+      /** create or replace the shared memory ring
+       * a ring replaced under the same name is closed, its readers have to open a new TelemetryReader
+       * @arg name: shared memory name, e.g. /act_schilling_pan
+       * @arg capacity: number of samples kept in the ring
+       * throws std::runtime_error
+      */
+      TelemetryPublisher(std::string const& name, uint32_t capacity = 256);
+      /** closes and unmaps the ring, the shared memory is removed unless keep has been set
+      */
+      ~TelemetryPublisher();
+      /** publish a sample
+      */
+      void publish(ActData const& data, ActDeviceStatus const& status);
+      /** publish a sample
+      */
+      void publish(TelemetrySample const& sample);
+      /** @return sequence number of the last published sample, 0 if none
+      */
+      uint64_t getSequence() const;
+      /** keep the shared memory after destruction, so readers can still fetch the last samples
+      */
+      void setKeep(bool keep);
+    private:
+      TelemetryPublisher(TelemetryPublisher const&);
+      TelemetryPublisher& operator=(TelemetryPublisher const&);
+      std::string mName;
+      shm::Ring* mRing;
+      size_t mSize;
+      bool mKeep;
+  };
+
+  /** Reads telemetry published by TelemetryPublisher, without locks and system calls after opening
+  */
+  class TelemetryReader
+  {
+    public:
+      /** open the shared memory ring read only
+       * throws std::runtime_error if it does not exist or is no telemetry ring
+      */
+      TelemetryReader(std::string const& name);
+      ~TelemetryReader();
+      /** @return sequence number of the last published sample, 0 if none
+      */
+      uint64_t getSequence() const;
+      /** @return true once the publisher has been destroyed or replaced, no new samples follow
+       * samples already published can still be read, open a new reader to follow a new publisher
+      */
+      bool isClosed() const;
+      /** read the sample with the given sequence number
+       * @return false if it has not been published yet or has already been overwritten
+      */
+      bool read(uint64_t seq, TelemetrySample& sample) const;
+      /** read the latest sample
+       * @arg seq: if given, receives the sequence number of the sample
+       * @return false if no sample has been published or the writer kept the latest one busy, e.g. because it died during an update
+      */
+      bool readLatest(TelemetrySample& sample, uint64_t* seq = 0) const;
+      /** read the next sample after the last one read by readNext, skips samples already overwritten
+       * a sample still being written is not skipped, call again later to get it
+       * @arg seq: if given, receives the sequence number of the sample
+       * @return false if there is no new sample or it is still being written
+      */
+      bool readNext(TelemetrySample& sample, uint64_t* seq = 0);
+    private:
+      TelemetryReader(TelemetryReader const&);
+      TelemetryReader& operator=(TelemetryReader const&);
+      shm::Ring const* mRing;
+      size_t mSize;
+      uint64_t mNext;
+  };
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef _ACT_SCHILLING_TRANSPORT_HPP_
+#define _ACT_SCHILLING_TRANSPORT_HPP_
+
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+#include <base/Time.hpp>
+
+namespace act_schilling
+{
+
+  /** Thrown by Driver when a transport delivers no data within the read timeout, like the timeout error of the serial I/O
+  */
+  class TransportTimeout : public std::runtime_error
+  {
+    public:
+      TransportTimeout(std::string const& what = "transport read timeout")
+	: std::runtime_error(what)
+      {}
+  };
+
+  /** Byte stream used by Driver instead of its own I/O, e.g. to run the driver against an in-memory device
+   * Driver splits the stream into packets with extractPacket, as it does for the serial I/O
+  */
+  class Transport
+  {
+    public:
+      virtual ~Transport() {}
+      /** read the bytes available, waits up to timeout for the first byte
+       * @arg buffer: buffer receiving the bytes
+       * @arg buffer_size: size of buffer
+       * @arg timeout: read timeout, null for the default timeout of the transport
+       * @return number of bytes read, 0 if the timeout expired
+      */
+      virtual int readBytes(uint8_t* buffer, int buffer_size, base::Time const& timeout = base::Time()) = 0;
+      /** write bytes
+       * @return true if the bytes have been written
+      */
+      virtual bool writeBytes(uint8_t const* buffer, int buffer_size) = 0;
+  };
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef _ACT_SCHILLING_TEST_HELPERS_HPP_
+#define _ACT_SCHILLING_TEST_HELPERS_HPP_
+
+#include <boost/test/unit_test.hpp>
+#include <act_schilling/Driver.hpp>
+#include <act_schilling/SimTransport.hpp>
+
+namespace act_schilling
+{
+  namespace test
+  {
+    /** simulated actuator recording every command written to it
+    */
+    class RecordingSim : public SimTransport
+    {
+      public:
+        std::vector<std::vector<uint8_t> > cmds;
+        /** @return number of recorded commands of the given type
+        */
+        size_t count(raw::CMD cmd) const
+        {
+          size_t n = 0;
+          for(size_t i=0;i<cmds.size();i++){
+            n += cmds[i][2] == cmd;
+          }
+          return n;
+        }
+        /** @return index of the first recorded command of the given type at or after start, -1 if none
+        */
+        int find(raw::CMD cmd, size_t start = 0) const
+        {
+          for(size_t i=start;i<cmds.size();i++){
+            if(cmds[i][2] == cmd){
+              return i;
+            }
+          }
+          return -1;
+        }
+        /** @return unsigned big endian value of a recorded command
+        */
+        unsigned int value(size_t i) const
+        {
+          unsigned int v = 0;
+          for(size_t j=3;j+1<cmds[i].size();j++){
+            v = (v << 8) | cmds[i][j];
+          }
+          return v;
+        }
+      protected:
+        virtual void reply(std::vector<uint8_t> const& cmd, std::vector<uint8_t>& frame)
+        {
+          cmds.push_back(cmd);
+          SimTransport::reply(cmd,frame);
+        }
+    };
+
+    /** GETSTAT reply frame in position mode
+     * @arg pos: shaft position in encoder counts
+    */
+    inline std::vector<uint8_t> statReply(int pos)
+    {
+      //ctrl status, drive status, ctrl mode, shaft position and velocity
+      std::vector<uint8_t> payload(9,0);
+      payload[2] = MODE_POS;
+      for(int i=0;i<4;i++){
+        payload[3+i] = (pos >> (8*(3-i))) & 0xFF;
+      }
+      return MockTransport::makeReply(payload);
+    }
+    /** write the queued commands and read their replies
+     * @return false if a read failed
+    */
+    inline bool drain(Driver& driver)
+    {
+      for(int i=0;i<100 && driver.getQueueDepth();i++){
+        driver.writeNext();
+        try{
+          driver.read();
+        }
+        catch(std::exception& e){
+          return false;
+        }
+      }
+      return !driver.getQueueDepth();
+    }
+
+    /** bring the driver up to INITIALIZED against the simulated actuator
+    */
+    inline void init(Driver& driver, SimTransport& sim)
+    {
+      driver.setTransport(&sim);
+      driver.initDevice();
+      BOOST_REQUIRE(drain(driver));
+      driver.requestStatus();
+      BOOST_REQUIRE(drain(driver));
+      BOOST_REQUIRE(driver.getState().initialized);
+    }
+
+    /** initialize and calibrate the driver against the simulated actuator
+    */
+    inline void calibrate(Driver& driver, SimTransport& sim)
+    {
+      init(driver,sim);
+      driver.calibrate();
+      for(int i=0;i<10000 && !driver.getState().calibrated;i++){
+        if(!driver.getQueueDepth()){
+          driver.requestStatus();
+        }
+        driver.writeNext();
+        driver.read();
+      }
+      BOOST_REQUIRE(driver.getState().calibrated);
+      BOOST_REQUIRE(drain(driver));
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,403 @@
+#include <boost/test/unit_test.hpp>
+#include <unistd.h>
+#include <base_schilling/SchillingRaw.hpp>
+#include "Helpers.hpp"
+
+using namespace act_schilling;
+using namespace act_schilling::test;
+
+/** calibrated driver in velocity mode, jogging with all start commands written
+*/
+static void startJog(Driver& driver, RecordingSim& sim)
+{
+  calibrate(driver,sim);
+  driver.startJog();
+  BOOST_REQUIRE(drain(driver));
+  BOOST_REQUIRE(driver.isJogging());
+}
+
+static Config jogConfig(int watchdog)
+{
+  Config config;
+  config.ctrl_mode = MODE_VEL;
+  config.jog_deadband = 10;
+  config.jog_watchdog = watchdog;
+  return config;
+}
+
+BOOST_AUTO_TEST_CASE(it_sends_jog_velocities_outside_the_deadband_only)
+{
+  RecordingSim sim;
+  Driver driver(jogConfig(0));
+  startJog(driver,sim);
+  driver.jog(5);
+  BOOST_CHECK_EQUAL(0u, driver.getQueueDepth());
+  driver.jog(50);
+  BOOST_CHECK_EQUAL(1u, driver.getQueueDepth());
+  BOOST_REQUIRE(drain(driver));
+  driver.jog(55);
+  BOOST_CHECK_EQUAL(0u, driver.getQueueDepth());
+  //stopping is never swallowed by the deadband
+  driver.jog(0);
+  BOOST_CHECK_EQUAL(1u, driver.getQueueDepth());
+}
+
+BOOST_AUTO_TEST_CASE(it_refreshes_the_jog_velocity_before_the_watchdog_expires)
+{
+  RecordingSim sim;
+  Driver driver(jogConfig(40));
+  startJog(driver,sim);
+  int wd = sim.find(raw::CMD_SETWD,sim.cmds.size()-2);
+  BOOST_REQUIRE(wd >= 0);
+  BOOST_CHECK_EQUAL(40u, sim.value(wd));
+  driver.jog(50);
+  BOOST_REQUIRE(drain(driver));
+  driver.jog(50);
+  BOOST_CHECK_EQUAL(0u, driver.getQueueDepth());
+  usleep(25000);
+  driver.jog(50);
+  BOOST_CHECK_EQUAL(1u, driver.getQueueDepth());
+}
+
+BOOST_AUTO_TEST_CASE(it_does_not_refresh_without_watchdog)
+{
+  RecordingSim sim;
+  Driver driver(jogConfig(0));
+  startJog(driver,sim);
+  driver.jog(50);
+  BOOST_REQUIRE(drain(driver));
+  usleep(25000);
+  driver.jog(50);
+  BOOST_CHECK_EQUAL(0u, driver.getQueueDepth());
+}
+
+BOOST_AUTO_TEST_CASE(it_clamps_the_jog_watchdog_to_two_bytes)
+{
+  RecordingSim sim;
+  Driver driver(jogConfig(70000));
+  startJog(driver,sim);
+  int wd = sim.find(raw::CMD_SETWD,sim.cmds.size()-2);
+  BOOST_REQUIRE(wd >= 0);
+  BOOST_CHECK_EQUAL(0xFFFFu, sim.value(wd));
+}
+
+BOOST_AUTO_TEST_CASE(it_ends_jog_mode_when_calibrating)
+{
+  RecordingSim sim;
+  Driver driver(jogConfig(500));
+  startJog(driver,sim);
+  size_t start = sim.cmds.size();
+  driver.calibrate();
+  BOOST_CHECK(!driver.isJogging());
+  BOOST_REQUIRE(drain(driver));
+  //the watchdog has been disarmed before the sweep
+  int wd = sim.find(raw::CMD_SETWD,start);
+  BOOST_REQUIRE(wd >= 0);
+  BOOST_CHECK_EQUAL(0u, sim.value(wd));
+  //jog mode cannot be entered during the sweep
+  driver.startJog();
+  driver.jog(5000);
+  BOOST_CHECK(!driver.isJogging());
+  BOOST_CHECK_EQUAL(0u, driver.getQueueDepth());
+}
+
+BOOST_AUTO_TEST_CASE(it_tells_an_accepted_command_from_a_rejected_one)
+{
+  Config config;
+  config.ctrl_mode = MODE_POS;
+  config.max_queue_depth = ActHandler::POS_MSGS;
+  Driver driver(config);
+  BOOST_CHECK_EQUAL(QUEUE_FULL, driver.setPos(1000));
+  BOOST_CHECK_EQUAL(ActHandler::POS_MSGS, driver.getQueueDepth());
+  BOOST_CHECK_EQUAL(QUEUE_REJECTED, driver.setPos(2000));
+  BOOST_CHECK_EQUAL(QUEUE_REJECTED, driver.requestStatus());
+  BOOST_CHECK_EQUAL(QUEUE_REJECTED, driver.requestSnapshot());
+  BOOST_CHECK_EQUAL(ActHandler::POS_MSGS, driver.getQueueDepth());
+}
+
+BOOST_AUTO_TEST_CASE(it_rejects_position_moves_in_velocity_mode)
+{
+  Config config;
+  config.ctrl_mode = MODE_VEL;
+  SimTransport sim;
+  Driver driver(config);
+  calibrate(driver,sim);
+  uint32_t ticket = 1;
+  BOOST_CHECK_EQUAL(QUEUE_REJECTED, driver.setPos(1000,1,&ticket));
+  BOOST_CHECK_EQUAL(0u, ticket);
+  BOOST_CHECK_EQUAL(QUEUE_REJECTED, driver.setTrapPos(1000));
+  BOOST_CHECK_EQUAL(0u, driver.getQueueDepth());
+}
+
+static Config cprConfig(int counts_per_rev)
+{
+  Config config;
+  config.counts_per_rev = counts_per_rev;
+  return config;
+}
+
+BOOST_AUTO_TEST_CASE(it_round_trips_counts_through_angles)
+{
+  int cprs[] = {1000, ACT_FULLPOS, 1000000, 360000000};
+  for(size_t c=0;c<sizeof(cprs)/sizeof(cprs[0]);c++){
+    ActHandler handler(cprConfig(cprs[c]));
+    //a few revolutions in both directions, dense around zero and the revolution boundaries
+    int counts[] = {0, 1, -1, 7, -7, cprs[c]/2, -cprs[c]/2, cprs[c]-1, cprs[c], -cprs[c], 5*cprs[c]+3, -5*cprs[c]-3};
+    for(size_t i=0;i<sizeof(counts)/sizeof(counts[0]);i++){
+      BOOST_CHECK_EQUAL(counts[i], handler.udeg2count(handler.count2udeg(counts[i])));
+      BOOST_CHECK_EQUAL(counts[i], handler.ang2count(handler.count2ang(counts[i])));
+    }
+    for(int count=-2000;count<=2000;count++){
+      BOOST_REQUIRE_EQUAL(count, handler.udeg2count(handler.count2udeg(count)));
+      BOOST_REQUIRE_EQUAL(count, handler.ang2count(handler.count2ang(count)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(it_converts_beyond_the_range_of_int_micro_degrees)
+{
+  ActHandler handler(cprConfig(ACT_FULLPOS));
+  BOOST_CHECK_EQUAL(int64_t(3512195122LL), handler.count2udeg(2000000));
+  BOOST_CHECK_EQUAL(int64_t(-3512195122LL), handler.count2udeg(-2000000));
+  BOOST_CHECK_EQUAL(2000000, handler.udeg2count(3512195122LL));
+  BOOST_CHECK_EQUAL(ACT_FULLPOS/4, handler.udeg2count(90000000));
+  BOOST_CHECK_EQUAL(ACT_FULLPOS/4, handler.ang2count(90));
+}
+
+BOOST_AUTO_TEST_CASE(it_rounds_to_the_nearest_count)
+{
+  ActHandler handler(cprConfig(360));
+  BOOST_CHECK_EQUAL(1, handler.udeg2count(500000));
+  BOOST_CHECK_EQUAL(0, handler.udeg2count(499999));
+  BOOST_CHECK_EQUAL(-1, handler.udeg2count(-500000));
+  BOOST_CHECK_EQUAL(1, handler.ang2count(0.5));
+  BOOST_CHECK_EQUAL(0, handler.ang2count(0.49));
+}
+
+BOOST_AUTO_TEST_CASE(it_falls_back_to_the_default_counts_per_rev_outside_the_valid_range)
+{
+  BOOST_CHECK_EQUAL(ACT_FULLPOS, ActHandler(cprConfig(0)).getConfig().counts_per_rev);
+  BOOST_CHECK_EQUAL(ACT_FULLPOS, ActHandler(cprConfig(1000000000)).getConfig().counts_per_rev);
+  BOOST_CHECK_EQUAL(360000000, ActHandler(cprConfig(360000000)).getConfig().counts_per_rev);
+}
+
+/** reply frame with payload bytes counting up from first
+*/
+static std::vector<uint8_t> countingReply(size_t payload_size, uint8_t first)
+{
+  std::vector<uint8_t> payload(payload_size);
+  for(size_t i=0;i<payload_size;i++){
+    payload[i] = first + 0x11*i;
+  }
+  return MockTransport::makeReply(payload);
+}
+
+/** position, drive status and actuator info decoded from reply frames the way parseReply did before decoding was deferred
+*/
+static ActPosition eagerPosition(std::vector<uint8_t> const& b)
+{
+  ActPosition pos;
+  pos.ext_encoder_status = b[2];
+  pos.ext_abs_pos = b[4];
+  pos.ext_abs_pos |= b[3] << 8;
+  pos.shaft_pos = b[8];
+  pos.shaft_pos |= b[7] << 8;
+  pos.shaft_pos |= b[6] << 16;
+  pos.shaft_pos |= b[5] << 24;
+  pos.shaft_enc_status = b[9];
+  pos.shaft_abs_pos = b[11];
+  pos.shaft_abs_pos |= b[10] << 8;
+  return pos;
+}
+
+static ActDriveStatus eagerDriveStatus(std::vector<uint8_t> const& b)
+{
+  ActDriveStatus status;
+  status.drive_status = b[2];
+  status.drive_protect_status = b[4];
+  status.drive_protect_status |= b[3] << 8;
+  status.system_protect_status = b[6];
+  status.system_protect_status |= b[5] << 8;
+  status.drive_system_status1 = b[8];
+  status.drive_system_status1 |= b[7] << 8;
+  status.drive_system_status2 = b[10];
+  status.drive_system_status2 |= b[9] << 8;
+  return status;
+}
+
+static ActInfo eagerActInfo(std::vector<uint8_t> const& b)
+{
+  ActInfo info;
+  info.serial_no = b[7];
+  info.serial_no |= b[6];
+  info.firmware_rev = b[8];
+  return info;
+}
+
+static void checkPosition(ActPosition const& expected, ActPosition const& actual)
+{
+  BOOST_CHECK_EQUAL(expected.ext_encoder_status, actual.ext_encoder_status);
+  BOOST_CHECK_EQUAL(expected.ext_abs_pos, actual.ext_abs_pos);
+  BOOST_CHECK_EQUAL(expected.shaft_pos, actual.shaft_pos);
+  BOOST_CHECK_EQUAL(expected.shaft_enc_status, actual.shaft_enc_status);
+  BOOST_CHECK_EQUAL(expected.shaft_abs_pos, actual.shaft_abs_pos);
+}
+
+static void checkDriveStatus(ActDriveStatus const& expected, ActDriveStatus const& actual)
+{
+  BOOST_CHECK_EQUAL(expected.drive_status, actual.drive_status);
+  BOOST_CHECK_EQUAL(expected.drive_protect_status, actual.drive_protect_status);
+  BOOST_CHECK_EQUAL(expected.system_protect_status, actual.system_protect_status);
+  BOOST_CHECK_EQUAL(expected.drive_system_status1, actual.drive_system_status1);
+  BOOST_CHECK_EQUAL(expected.drive_system_status2, actual.drive_system_status2);
+}
+
+static void checkActInfo(ActInfo const& expected, ActInfo const& actual)
+{
+  BOOST_CHECK_EQUAL(expected.serial_no, actual.serial_no);
+  BOOST_CHECK_EQUAL(expected.firmware_rev, actual.firmware_rev);
+}
+
+BOOST_AUTO_TEST_CASE(it_decodes_the_same_values_as_the_eager_decode)
+{
+  SimTransport sim;
+  Driver driver;
+  init(driver,sim);
+  //high bytes set, so sign extension and byte order both show
+  std::vector<uint8_t> pos = countingReply(10,0x81);
+  std::vector<uint8_t> drive = countingReply(9,0x92);
+  std::vector<uint8_t> info = countingReply(9,0xA3);
+  sim.addReply(pos);
+  sim.addReply(drive);
+  sim.addReply(info);
+  driver.requestPosition();
+  driver.requestDriveStatus();
+  driver.requestActInfo();
+  BOOST_REQUIRE(drain(driver));
+  checkPosition(eagerPosition(pos), driver.getPosition());
+  checkDriveStatus(eagerDriveStatus(drive), driver.getDriveStatus());
+  checkActInfo(eagerActInfo(info), driver.getActInfo());
+}
+
+BOOST_AUTO_TEST_CASE(it_decodes_once_per_reply)
+{
+  SimTransport sim;
+  Driver driver;
+  init(driver,sim);
+  std::vector<uint8_t> first = countingReply(10,0x01);
+  sim.addReply(first);
+  driver.requestPosition();
+  BOOST_REQUIRE(drain(driver));
+  ActPosition decoded = driver.getPosition();
+  checkPosition(eagerPosition(first), decoded);
+  //the memoized decode keeps the receive time instead of taking a new one on each call
+  usleep(2000);
+  ActPosition again = driver.getPosition();
+  checkPosition(decoded, again);
+  BOOST_CHECK_EQUAL(decoded.time.toMicroseconds(), again.time.toMicroseconds());
+  //a new reply is decoded on the next call
+  std::vector<uint8_t> second = countingReply(10,0x42);
+  sim.addReply(second);
+  driver.requestPosition();
+  BOOST_REQUIRE(drain(driver));
+  ActPosition next = driver.getPosition();
+  checkPosition(eagerPosition(second), next);
+  BOOST_CHECK(next.time > decoded.time);
+}
+
+BOOST_AUTO_TEST_CASE(it_fills_the_snapshot_with_the_decoded_fields)
+{
+  SimTransport sim;
+  Driver driver;
+  init(driver,sim);
+  std::vector<uint8_t> pos = countingReply(10,0x81);
+  std::vector<uint8_t> drive = countingReply(9,0x92);
+  std::vector<uint8_t> info = countingReply(9,0xA3);
+  sim.addReply(statReply(0));
+  sim.addReply(pos);
+  sim.addReply(drive);
+  sim.addReply(info);
+  BOOST_CHECK_EQUAL(QUEUE_OK, driver.requestSnapshot());
+  BOOST_REQUIRE(drain(driver));
+  ActSnapshot snapshot;
+  BOOST_CHECK_EQUAL(uint32_t(SNAP_STATUS | SNAP_POS | SNAP_DRIVE_STATUS | SNAP_ACT_INFO), driver.collectSnapshot(snapshot));
+  checkPosition(eagerPosition(pos), snapshot.position);
+  checkDriveStatus(eagerDriveStatus(drive), snapshot.drive_status);
+  checkActInfo(eagerActInfo(info), snapshot.act_info);
+  BOOST_CHECK_EQUAL(pos[9], snapshot.status.encoder_status);
+  //nothing new since the last collect
+  BOOST_CHECK_EQUAL(0u, driver.collectSnapshot(snapshot));
+  checkPosition(eagerPosition(pos), snapshot.position);
+}
+
+BOOST_AUTO_TEST_CASE(it_reports_earlier_tickets_as_superseded)
+{
+  SimTransport sim;
+  Config config;
+  config.ctrl_mode = MODE_POS;
+  Driver driver(config);
+  calibrate(driver,sim);
+  uint32_t first, second;
+  driver.setPos(1000,1,&first);
+  driver.setPos(2000,1,&second);
+  BOOST_REQUIRE(first && second && first < second);
+  //0 and tickets not handed out yet are unknown, waiting for them returns at once
+  BOOST_CHECK_EQUAL(MOVE_NONE, driver.waitMove(0,base::Time::fromSeconds(1)).state);
+  BOOST_CHECK(!driver.isMoveCompleted(0));
+  BOOST_CHECK_EQUAL(MOVE_NONE, driver.getMoveStatus(second+1).state);
+  BOOST_CHECK(!driver.isMoveCompleted(second+1));
+  MoveStatus status = driver.waitMove(first,base::Time::fromSeconds(1));
+  BOOST_CHECK_EQUAL(MOVE_SUPERSEDED, status.state);
+  BOOST_CHECK_EQUAL(first, status.ticket);
+  BOOST_CHECK(driver.isMoveCompleted(first));
+  status = driver.waitMove(second,base::Time::fromSeconds(10));
+  BOOST_CHECK_EQUAL(MOVE_DONE, status.state);
+  BOOST_CHECK_EQUAL(second, status.ticket);
+  BOOST_CHECK(driver.isMoveCompleted(second));
+  BOOST_CHECK_EQUAL(MOVE_SUPERSEDED, driver.getMoveStatus(first).state);
+}
+
+BOOST_AUTO_TEST_CASE(it_sets_the_velocity_before_the_trapezoidal_move)
+{
+  Config config;
+  config.ctrl_mode = MODE_POS;
+  config.trap_accel = 5000;
+  RecordingSim sim;
+  Driver driver(config);
+  calibrate(driver,sim);
+  //the acceleration is sent as is, in counts/s^2
+  int accel = sim.find(raw::CMD_SETTRAPVEL);
+  BOOST_REQUIRE(accel >= 0);
+  BOOST_CHECK_EQUAL(5000u, sim.value(accel));
+  sim.cmds.clear();
+  BOOST_CHECK_EQUAL(QUEUE_OK, driver.setTrapPos(1000,0.5));
+  BOOST_REQUIRE(drain(driver));
+  int vel = sim.find(raw::CMD_SETVEL);
+  int pos = sim.find(raw::CMD_SETTRAPPOS);
+  BOOST_REQUIRE(vel >= 0 && pos >= 0);
+  BOOST_CHECK(vel < pos);
+  BOOST_CHECK_EQUAL(unsigned(ACT_VEL_COEFF*config.velocity*0.5), sim.value(vel));
+  BOOST_CHECK_EQUAL(1000u, sim.value(pos));
+  BOOST_CHECK_EQUAL(0u, sim.count(raw::CMD_SETSHAFTPOS));
+}
+
+BOOST_AUTO_TEST_CASE(it_falls_back_to_a_plain_move_without_trap_accel)
+{
+  Config config;
+  config.ctrl_mode = MODE_POS;
+  config.trap_accel = -1;
+  SimTransport sim;
+  Driver driver(config);
+  init(driver,sim);
+  BOOST_CHECK_EQUAL(0, driver.getConfig().trap_accel);
+  driver.setTrapPos(1000);
+  bool trap = false;
+  while(driver.getQueueDepth()){
+    driver.writeNext();
+    trap = trap || sim.getLastCmd() == raw::CMD_SETTRAPPOS;
+    driver.read();
+  }
+  BOOST_CHECK(!trap);
+  driver.setTrapAccel(0x1000000);
+  BOOST_CHECK_EQUAL(0xFFFFFF, driver.getConfig().trap_accel);
+}
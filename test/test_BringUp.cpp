@@ -0,0 +1,52 @@
+#include <boost/test/unit_test.hpp>
+#include <base_schilling/SchillingRaw.hpp>
+#include <act_schilling/BringUp.hpp>
+#include "Helpers.hpp"
+
+using namespace act_schilling;
+using namespace act_schilling::test;
+
+BOOST_AUTO_TEST_CASE(it_brings_up_axes_over_lossy_links)
+{
+  Config config;
+  config.ctrl_mode = MODE_POS;
+  SimTransport pan, tilt;
+  pan.setCorruption(40);
+  tilt.setTruncation(60);
+  tilt.setLatency(base::Time::fromMilliseconds(20));
+  Driver panDriver(config), tiltDriver(config);
+  panDriver.setTransport(&pan);
+  tiltDriver.setTransport(&tilt);
+  BringUp bringUp(base::Time::fromSeconds(600),100);
+  bringUp.addAxis(&panDriver);
+  bringUp.addAxis(&tiltDriver,0);
+  BOOST_CHECK(bringUp.run());
+  BOOST_CHECK(pan.getCorruptCount() > 0);
+  BOOST_CHECK(tilt.getCorruptCount() > 0);
+  BOOST_CHECK(panDriver.getState().calibrated);
+  BOOST_CHECK(tiltDriver.getState().calibrated);
+}
+
+BOOST_AUTO_TEST_CASE(it_fails_interlock_cycles_before_opening_the_devices)
+{
+  Config config;
+  config.ctrl_mode = MODE_POS;
+  SimTransport sim;
+  Driver driver(config);
+  driver.setTransport(&sim);
+  BringUp bringUp(base::Time::fromSeconds(600));
+  //the uris cannot be opened, the axes would fail with an io error if they were started
+  bringUp.addAxis("none://pan",config,1);
+  bringUp.addAxis("none://tilt",config,0);
+  bringUp.addAxis("none://self",config,2);
+  bringUp.addAxis("none://range",config,5);
+  bringUp.addAxis(&driver,0);
+  BOOST_CHECK(!bringUp.run());
+  BOOST_CHECK_EQUAL("interlock cycle", bringUp.getProgress(0).error);
+  BOOST_CHECK_EQUAL("interlock cycle", bringUp.getProgress(1).error);
+  BOOST_CHECK_EQUAL("invalid interlock axis", bringUp.getProgress(2).error);
+  BOOST_CHECK_EQUAL("invalid interlock axis", bringUp.getProgress(3).error);
+  //not part of the cycle, it fails with the axis it waits for
+  BOOST_CHECK_EQUAL("interlock axis failed", bringUp.getProgress(4).error);
+  BOOST_CHECK(bringUp.getTotalTime() < base::Time::fromSeconds(1));
+}
@@ -0,0 +1,111 @@
+#include <boost/test/unit_test.hpp>
+#include <act_schilling/HealthMonitor.hpp>
+#include <act_schilling/ActRaw.hpp>
+#include "Helpers.hpp"
+
+using namespace act_schilling;
+using namespace act_schilling::test;
+
+static base::Time at(int ms)
+{
+  return base::Time::fromMilliseconds(ms);
+}
+
+BOOST_AUTO_TEST_CASE(it_maps_each_status_bit_to_its_fault)
+{
+  //status byte (0 ctrl, 1 drive, 2 encoder), mask and name of each fault in enum order
+  struct { int byte; uint8_t mask; const char* name; } bits[FAULT_COUNT] = {
+    {0,ACT_CTRL_WD_TIME,"CTRL_WD_TIME"},
+    {0,ACT_CTRL_EXT_ENC_MAG,"CTRL_EXT_ENC_MAG"},
+    {0,ACT_CTRL_EXT_ENC_COMM,"CTRL_EXT_ENC_COMM"},
+    {0,ACT_CTRL_SH_ENC_MAG,"CTRL_SH_ENC_MAG"},
+    {0,ACT_CTRL_WATER,"CTRL_WATER"},
+    {0,ACT_CTRL_SH_ENC_COMM,"CTRL_SH_ENC_COMM"},
+    {1,ACT_DRV_CMD_INC,"DRV_CMD_INC"},
+    {1,ACT_DRV_CMD_INV,"DRV_CMD_INV"},
+    {1,ACT_DRV_FRAME_ERR,"DRV_FRAME_ERR"},
+    {1,ACT_DRV_VOLT_TEMP,"DRV_VOLT_TEMP"},
+    {1,ACT_DRV_COMM_PHASE,"DRV_COMM_PHASE"},
+    {2,ACT_ENC_LIN_ALARM,"ENC_LIN_ALARM"},
+    {2,ACT_ENC_RANGE_ERR,"ENC_RANGE_ERR"}
+  };
+  for(int f=0;f<FAULT_COUNT;f++){
+    HealthMonitor monitor;
+    uint8_t status[3] = {0,0,0};
+    status[bits[f].byte] = bits[f].mask;
+    monitor.updateStatus(status[0],status[1],at(1));
+    monitor.updateEncoder(status[2],at(1));
+    for(int g=0;g<FAULT_COUNT;g++){
+      BOOST_CHECK_EQUAL(f == g, monitor.getStats((Fault)g).active);
+    }
+    BOOST_CHECK_EQUAL(std::string(bits[f].name), HealthMonitor::getFaultName((Fault)f));
+  }
+  BOOST_CHECK_EQUAL(std::string("UNKNOWN"), HealthMonitor::getFaultName(FAULT_COUNT));
+}
+
+BOOST_AUTO_TEST_CASE(it_counts_raised_edges_and_samples)
+{
+  HealthMonitor monitor;
+  uint8_t sequence[] = {0,ACT_CTRL_WATER,ACT_CTRL_WATER,0,ACT_CTRL_WATER,0};
+  for(size_t i=0;i<sizeof(sequence);i++){
+    monitor.updateStatus(sequence[i],0,at(10*(i+1)));
+  }
+  FaultStats const& water = monitor.getStats(FAULT_CTRL_WATER);
+  BOOST_CHECK_EQUAL(2u, water.raised);
+  BOOST_CHECK_EQUAL(3u, water.samples);
+  BOOST_CHECK(!water.active);
+  BOOST_CHECK_EQUAL(20, water.first_seen.toMilliseconds());
+  BOOST_CHECK_EQUAL(50, water.last_seen.toMilliseconds());
+  BOOST_CHECK_EQUAL(6u, monitor.getSampleCount());
+  BOOST_CHECK(monitor.getStats(FAULT_DRV_CMD_INC).first_seen.isNull());
+  //raised, cleared, raised, cleared
+  FaultEvent event;
+  bool raised = true;
+  for(int i=0;i<4;i++){
+    BOOST_REQUIRE(monitor.popEvent(event));
+    BOOST_CHECK_EQUAL(FAULT_CTRL_WATER, event.fault);
+    BOOST_CHECK_EQUAL(raised, event.raised);
+    raised = !raised;
+  }
+  BOOST_CHECK(!monitor.popEvent(event));
+}
+
+BOOST_AUTO_TEST_CASE(it_drops_the_oldest_events_when_they_are_not_fetched)
+{
+  HealthMonitor monitor(2);
+  for(int i=0;i<5;i++){
+    monitor.updateEncoder(i % 2 ? 0 : ACT_ENC_RANGE_ERR,at(i));
+  }
+  BOOST_CHECK_EQUAL(3u, monitor.getDroppedEvents());
+  FaultEvent event;
+  BOOST_REQUIRE(monitor.popEvent(event));
+  BOOST_CHECK_EQUAL(3, event.time.toMilliseconds());
+  BOOST_CHECK(!event.raised);
+  BOOST_REQUIRE(monitor.popEvent(event));
+  BOOST_CHECK_EQUAL(4, event.time.toMilliseconds());
+  BOOST_CHECK(event.raised);
+  BOOST_CHECK(!monitor.popEvent(event));
+  monitor.reset();
+  BOOST_CHECK_EQUAL(0u, monitor.getDroppedEvents());
+  BOOST_CHECK(!monitor.hasActiveFault());
+}
+
+BOOST_AUTO_TEST_CASE(it_decodes_faults_from_the_device_replies)
+{
+  SimTransport sim;
+  Driver driver;
+  init(driver,sim);
+  sim.setStatusBytes(ACT_CTRL_WD_TIME,ACT_DRV_VOLT_TEMP,ACT_ENC_LIN_ALARM);
+  driver.requestStatus();
+  BOOST_REQUIRE(drain(driver));
+  HealthMonitor& health = driver.getHealthMonitor();
+  BOOST_CHECK(health.getStats(FAULT_CTRL_WD_TIME).active);
+  BOOST_CHECK(health.getStats(FAULT_DRV_VOLT_TEMP).active);
+  BOOST_CHECK(health.getStats(FAULT_ENC_LIN_ALARM).active);
+  BOOST_CHECK(!health.getStats(FAULT_CTRL_WATER).active);
+  sim.setStatusBytes(0,0,0);
+  driver.requestStatus();
+  BOOST_REQUIRE(drain(driver));
+  BOOST_CHECK(!health.hasActiveFault());
+  BOOST_CHECK_EQUAL(1u, health.getStats(FAULT_CTRL_WD_TIME).raised);
+}
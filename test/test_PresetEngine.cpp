@@ -0,0 +1,89 @@
+#include <boost/test/unit_test.hpp>
+#include <act_schilling/PresetEngine.hpp>
+#include "Helpers.hpp"
+
+using namespace act_schilling;
+using namespace act_schilling::test;
+
+static Config posConfig(int velocity = 1000)
+{
+  Config config;
+  config.ctrl_mode = MODE_POS;
+  config.velocity = velocity;
+  return config;
+}
+
+static std::vector<PanTiltDefaultPos> presets(int pan, int tilt)
+{
+  std::vector<int> pos(2);
+  pos[0] = pan;
+  pos[1] = tilt;
+  return std::vector<PanTiltDefaultPos>(1,PanTiltDefaultPos(base::Time(),pos));
+}
+
+BOOST_AUTO_TEST_CASE(it_requires_a_positive_counts_per_vel)
+{
+  BOOST_CHECK_THROW(PresetEngine(0), std::runtime_error);
+  BOOST_CHECK_THROW(PresetEngine(-1), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(it_clamps_presets_to_the_boundaries)
+{
+  SimTransport panSim, tiltSim;
+  Driver pan(posConfig()), tilt(posConfig());
+  calibrate(pan,panSim);
+  calibrate(tilt,tiltSim);
+  PresetEngine engine(1);
+  engine.addAxis(&pan);
+  engine.addAxis(&tilt);
+  engine.setPresets(presets(170,-30));
+  BOOST_REQUIRE(engine.compile());
+  std::vector<int> const& counts = engine.getPresetCounts(0);
+  BOOST_CHECK_EQUAL(pan.ang2count(pan.getBoundaries().max), counts[0]);
+  BOOST_CHECK_EQUAL(tilt.ang2count(-30), counts[1]);
+}
+
+BOOST_AUTO_TEST_CASE(it_makes_all_axes_arrive_at_the_same_time)
+{
+  RecordingSim panSim, tiltSim;
+  Driver pan(posConfig()), tilt(posConfig());
+  calibrate(pan,panSim);
+  calibrate(tilt,tiltSim);
+  PresetEngine engine(2);
+  engine.addAxis(&pan);
+  engine.addAxis(&tilt);
+  engine.setPresets(presets(60,-20));
+  size_t panStart = panSim.cmds.size(), tiltStart = tiltSim.cmds.size();
+  base::Time before = base::Time::now();
+  base::Time arrival = engine.goToPreset(0);
+  BOOST_REQUIRE(!arrival.isNull());
+  BOOST_REQUIRE(drain(pan));
+  BOOST_REQUIRE(drain(tilt));
+  int panVel = panSim.find(raw::CMD_SETVEL,panStart);
+  int tiltVel = tiltSim.find(raw::CMD_SETVEL,tiltStart);
+  BOOST_REQUIRE(panVel >= 0 && tiltVel >= 0);
+  //the longer travel runs at the configured velocity, the shorter one is slowed down
+  double panDist = abs(pan.ang2count(60) - pan.getDeviceStatus().shaft_pos);
+  double tiltDist = abs(tilt.ang2count(-20) - tilt.getDeviceStatus().shaft_pos);
+  BOOST_CHECK_EQUAL(1000*ACT_VEL_COEFF, panSim.value(panVel));
+  BOOST_CHECK_CLOSE(tiltDist/panDist, double(tiltSim.value(tiltVel))/panSim.value(panVel), 0.1);
+  BOOST_CHECK_CLOSE(panDist/(1000*2), (arrival-before).toSeconds(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(it_recompiles_after_recalibration)
+{
+  SimTransport wide, narrow(-ACT_FULLPOS/8,ACT_FULLPOS/8);
+  Driver pan(posConfig());
+  calibrate(pan,wide);
+  PresetEngine engine(1);
+  engine.addAxis(&pan);
+  engine.setPresets(std::vector<PanTiltDefaultPos>(1,PanTiltDefaultPos(base::Time(),std::vector<int>(1,80))));
+  BOOST_REQUIRE(engine.compile());
+  BOOST_CHECK_EQUAL(pan.ang2count(80), engine.getPresetCounts(0)[0]);
+  //the actuator is recalibrated on a mount with narrower end stops
+  pan.setResetState();
+  calibrate(pan,narrow);
+  BOOST_REQUIRE(pan.getBoundaries().max < 80);
+  BOOST_CHECK(!engine.goToPreset(0).isNull());
+  BOOST_CHECK_EQUAL(pan.ang2count(pan.getBoundaries().max), engine.getPresetCounts(0)[0]);
+}
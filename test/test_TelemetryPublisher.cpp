@@ -0,0 +1,142 @@
+#include <boost/test/unit_test.hpp>
+#include <act_schilling/TelemetryPublisher.hpp>
+#include <string.h>
+#include <pthread.h>
+
+using namespace act_schilling;
+
+static TelemetrySample sample(int pos)
+{
+  TelemetrySample s;
+  memset(&s,0,sizeof(s));
+  s.shaft_pos = pos;
+  return s;
+}
+
+BOOST_AUTO_TEST_CASE(it_reads_the_latest_sample)
+{
+  TelemetryPublisher publisher("/act_schilling_test_latest",4);
+  TelemetryReader reader("/act_schilling_test_latest");
+  TelemetrySample s;
+  BOOST_CHECK(!reader.readLatest(s));
+  publisher.publish(sample(1));
+  publisher.publish(sample(2));
+  uint64_t seq = 0;
+  BOOST_REQUIRE(reader.readLatest(s,&seq));
+  BOOST_CHECK_EQUAL(2u, seq);
+  BOOST_CHECK_EQUAL(2, s.shaft_pos);
+}
+
+BOOST_AUTO_TEST_CASE(it_skips_overwritten_samples_only)
+{
+  TelemetryPublisher publisher("/act_schilling_test_next",4);
+  TelemetryReader reader("/act_schilling_test_next");
+  for(int i=1;i<=10;i++){
+    publisher.publish(sample(i));
+  }
+  TelemetrySample s;
+  uint64_t seq = 0;
+  for(int i=7;i<=10;i++){
+    BOOST_REQUIRE(reader.readNext(s,&seq));
+    BOOST_CHECK_EQUAL(uint64_t(i), seq);
+    BOOST_CHECK_EQUAL(i, s.shaft_pos);
+  }
+  BOOST_CHECK(!reader.readNext(s));
+  publisher.publish(sample(11));
+  BOOST_REQUIRE(reader.readNext(s,&seq));
+  BOOST_CHECK_EQUAL(11u, seq);
+}
+
+BOOST_AUTO_TEST_CASE(it_closes_the_ring_when_the_publisher_is_replaced)
+{
+  TelemetryPublisher first("/act_schilling_test_replaced",4);
+  first.publish(sample(1));
+  TelemetryReader reader("/act_schilling_test_replaced");
+  BOOST_CHECK(!reader.isClosed());
+  {
+    //e.g. a restarted process while the first publisher died without destructor
+    TelemetryPublisher second("/act_schilling_test_replaced",4);
+    BOOST_CHECK(reader.isClosed());
+    TelemetrySample s;
+    BOOST_REQUIRE(reader.readLatest(s));
+    BOOST_CHECK_EQUAL(1, s.shaft_pos);
+    //the new ring has to be opened again
+    second.publish(sample(2));
+    TelemetryReader renewed("/act_schilling_test_replaced");
+    BOOST_CHECK(!renewed.isClosed());
+    BOOST_REQUIRE(renewed.readLatest(s));
+    BOOST_CHECK_EQUAL(2, s.shaft_pos);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(it_closes_a_kept_ring_on_destruction)
+{
+  TelemetryPublisher* publisher = new TelemetryPublisher("/act_schilling_test_kept",4);
+  publisher->setKeep(true);
+  TelemetryReader reader("/act_schilling_test_kept");
+  delete publisher;
+  BOOST_CHECK(reader.isClosed());
+  //removes the kept shared memory again
+  TelemetryPublisher cleanup("/act_schilling_test_kept",4);
+}
+
+static const int WRITER_SAMPLES = 100000;
+
+/** every field is derived from the sequence number, so a torn read shows as a mismatch
+*/
+static TelemetrySample seqSample(uint64_t seq)
+{
+  TelemetrySample s;
+  memset(&s,0,sizeof(s));
+  s.time_us = seq*1000;
+  s.ctrl_mode = seq % 3;
+  s.shaft_pos = seq;
+  s.shaft_ang = seq*0.5;
+  s.shaft_vel = -double(seq);
+  s.ctrl_status = seq;
+  s.drive_status = seq >> 8;
+  s.encoder_status = seq >> 16;
+  return s;
+}
+
+static void* writer(void* arg)
+{
+  TelemetryPublisher* publisher = (TelemetryPublisher*)arg;
+  for(int i=1;i<=WRITER_SAMPLES;i++){
+    publisher->publish(seqSample(i));
+  }
+  return 0;
+}
+
+BOOST_AUTO_TEST_CASE(it_reads_consistent_samples_while_the_writer_runs)
+{
+  TelemetryPublisher publisher("/act_schilling_test_concurrent",8);
+  TelemetryReader reader("/act_schilling_test_concurrent");
+  pthread_t thread;
+  BOOST_REQUIRE_EQUAL(0, pthread_create(&thread,0,writer,&publisher));
+  uint64_t last = 0;
+  int reads = 0, torn = 0;
+  while(last < uint64_t(WRITER_SAMPLES)){
+    TelemetrySample s;
+    uint64_t seq = 0;
+    if(!reader.readNext(s,&seq)){
+      continue;
+    }
+    reads++;
+    if(seq <= last){
+      break;
+    }
+    last = seq;
+    TelemetrySample expected = seqSample(seq);
+    torn += memcmp(&expected,&s,sizeof(s)) != 0;
+    TelemetrySample latest;
+    if(reader.readLatest(latest,&seq)){
+      expected = seqSample(seq);
+      torn += memcmp(&expected,&latest,sizeof(latest)) != 0;
+    }
+  }
+  pthread_join(thread,0);
+  BOOST_CHECK_EQUAL(uint64_t(WRITER_SAMPLES), last);
+  BOOST_CHECK(reads > 0);
+  BOOST_CHECK_EQUAL(0, torn);
+}
@@ -0,0 +1,111 @@
+#include <boost/test/unit_test.hpp>
+#include <base_schilling/SchillingRaw.hpp>
+#include "Helpers.hpp"
+
+using namespace act_schilling;
+using namespace act_schilling::test;
+
+BOOST_AUTO_TEST_CASE(it_initializes_and_calibrates_over_the_byte_stream)
+{
+  SimTransport sim;
+  Config config;
+  config.ctrl_mode = MODE_POS;
+  Driver driver(config);
+  calibrate(driver,sim);
+  BOOST_CHECK(driver.isIdle());
+}
+
+BOOST_AUTO_TEST_CASE(it_reassembles_replies_split_over_several_reads)
+{
+  SimTransport sim;
+  sim.setChunkSize(1);
+  Driver driver;
+  init(driver,sim);
+  driver.requestPosition();
+  BOOST_REQUIRE(drain(driver));
+  BOOST_CHECK(driver.hasPosUpdate());
+}
+
+BOOST_AUTO_TEST_CASE(it_resyncs_after_line_noise)
+{
+  SimTransport sim;
+  Driver driver;
+  init(driver,sim);
+  //noise, a header with an invalid length and a frame cut off by noise
+  uint8_t noise[] = {0x00, 0xFF, 0x42, SCHILL_REPL_UNCHG_MSG, 0x01, 0x13};
+  sim.injectBytes(std::vector<uint8_t>(noise,noise+sizeof(noise)));
+  driver.hasStatusUpdate();
+  driver.requestStatus();
+  BOOST_REQUIRE(drain(driver));
+  BOOST_CHECK(driver.hasStatusUpdate());
+  BOOST_CHECK(driver.isIdle());
+}
+
+BOOST_AUTO_TEST_CASE(it_rejects_a_reply_with_a_bad_checksum_and_recovers)
+{
+  SimTransport sim;
+  Driver driver;
+  init(driver,sim);
+  std::vector<uint8_t> bad = statReply(100);
+  bad[bad.size()-1] ^= 0x01;
+  sim.addReply(bad);
+  driver.hasStatusUpdate();
+  driver.requestStatus();
+  driver.writeNext();
+  BOOST_CHECK_THROW(driver.read(), std::exception);
+  BOOST_CHECK(!driver.hasStatusUpdate());
+  driver.requestStatus();
+  BOOST_REQUIRE(drain(driver));
+  BOOST_CHECK(driver.hasStatusUpdate());
+}
+
+BOOST_AUTO_TEST_CASE(it_times_out_on_a_truncated_reply_and_recovers)
+{
+  SimTransport sim;
+  Driver driver;
+  init(driver,sim);
+  sim.setTruncation(1);
+  driver.requestStatus();
+  driver.writeNext();
+  BOOST_CHECK_THROW(driver.read(), TransportTimeout);
+  BOOST_CHECK_EQUAL(1u, sim.getCorruptCount());
+  sim.setTruncation(0);
+  driver.clearReadBuffer();
+  driver.hasStatusUpdate();
+  driver.requestStatus();
+  BOOST_REQUIRE(drain(driver));
+  BOOST_CHECK(driver.hasStatusUpdate());
+}
+
+BOOST_AUTO_TEST_CASE(it_times_out_when_the_reply_is_late)
+{
+  SimTransport sim;
+  Driver driver;
+  init(driver,sim);
+  sim.setDefaultTimeout(base::Time::fromMilliseconds(100));
+  sim.setLatency(base::Time::fromMilliseconds(150));
+  driver.hasStatusUpdate();
+  driver.requestStatus();
+  driver.writeNext();
+  base::Time sent = sim.getTime();
+  BOOST_CHECK_THROW(driver.read(), TransportTimeout);
+  BOOST_CHECK(!driver.isIdle());
+  //the late reply is still delivered by the next read
+  driver.read();
+  BOOST_CHECK(driver.isIdle());
+  BOOST_CHECK_EQUAL(150000, (sim.getTime()-sent).toMicroseconds());
+  sim.setLatency(base::Time());
+  BOOST_REQUIRE(drain(driver));
+  BOOST_CHECK(driver.hasStatusUpdate());
+}
+
+BOOST_AUTO_TEST_CASE(it_reports_a_nak)
+{
+  SimTransport sim;
+  Driver driver;
+  init(driver,sim);
+  sim.addNak();
+  driver.requestStatus();
+  driver.writeNext();
+  BOOST_CHECK_THROW(driver.read(), std::exception);
+}